@@ -0,0 +1,438 @@
+#ifndef EH_ADAPTIVE_SET_H
+#define EH_ADAPTIVE_SET_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+// Extendible Hashing Set with Buckets in Classes size classes of N, 2N, ..., N * 2^(Classes - 1) keys.
+// A full Bucket whose split would double the directory (local depth = global depth) is grown to the next
+// class with realloc instead, only a Bucket of the largest class doubles it. Buckets below global depth
+// split as in EH_set, and both halves of a split shrink to the smallest class that holds their keys.
+// With skewed hashes the few hot Buckets take the extra keys, so the directory doubles less often
+// (Classes - 1 fewer times at most), while cold Buckets stay at N keys.
+// Keys must be trivially copyable, since Buckets are moved by realloc.
+template <typename Key, size_t N = 16, size_t Classes = 3> class EH_adaptive_set {
+    static_assert(std::is_trivially_copyable_v<Key>, "EH_adaptive_set needs trivially copyable keys");
+    static_assert(alignof(Key) <= alignof(std::max_align_t), "keys are stored behind a malloc'ed header");
+    static_assert(N > 0 && Classes > 0 && Classes < 16, "Bucket size out of range");
+
+  public:
+    using value_type = Key;
+    using key_type = Key;
+    using size_type = size_t;
+    using key_equal = std::equal_to<key_type>;
+    using hasher = std::hash<key_type>;
+
+  private:
+    // header of a Bucket, its N << cls keys follow at offset header, only the first arrsz are used
+    struct Bucket {
+        size_type l{0};      // local depth
+        size_type cls{0};    // size class
+        size_type arrsz{0};  // number of elems in Bucket
+
+        [[nodiscard]] key_type* keys() noexcept {
+            return std::launder(reinterpret_cast<key_type*>(reinterpret_cast<char*>(this) + header));
+        }
+        [[nodiscard]] const key_type* keys() const noexcept {
+            return std::launder(reinterpret_cast<const key_type*>(reinterpret_cast<const char*>(this) + header));
+        }
+        [[nodiscard]] size_type capacity() const noexcept { return N << cls; }
+        [[nodiscard]] size_type find(const key_type& key) const noexcept;
+        [[nodiscard]] size_type high_bit() const noexcept { return size_type{1} << l; }
+    };
+
+    static constexpr size_type header{(sizeof(Bucket) + alignof(Key) - 1) / alignof(Key) * alignof(Key)};
+
+    size_type sz;  // actual size
+    size_type d;   // global depth
+    size_type nD;  // 2^d
+    size_type nB;  // number of Buckets
+    Bucket** buckets;
+
+    [[nodiscard]] static size_type fit(size_type n) noexcept;
+    [[nodiscard]] static Bucket* allocate(size_type cls) noexcept;
+    void resize(size_type i, size_type cls) noexcept;
+    void expansion() noexcept;
+    void split_bucket(size_type hash) noexcept;
+
+  public:
+    EH_adaptive_set() noexcept;
+    EH_adaptive_set(std::initializer_list<key_type> ilist) noexcept;
+    template <typename InputIt> EH_adaptive_set(InputIt first, InputIt last) noexcept;
+    EH_adaptive_set(const EH_adaptive_set& other) noexcept;
+
+    ~EH_adaptive_set() noexcept;
+
+    EH_adaptive_set& operator=(const EH_adaptive_set& other) noexcept;
+
+    [[nodiscard]] size_type size() const noexcept;
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_type depth() const noexcept;
+    [[nodiscard]] size_type bucket_count() const noexcept;
+    [[nodiscard]] size_type slot_count() const noexcept;
+
+    bool insert(const key_type& key) noexcept;
+    template <typename InputIt> void insert(InputIt first, InputIt last) noexcept;
+
+    void clear() noexcept;
+
+    size_type erase(const key_type& key) noexcept;
+    [[nodiscard]] size_type count(const key_type& key) const noexcept;
+    template <typename F> void for_each(F f) const noexcept;
+
+    void swap(EH_adaptive_set& other) noexcept;
+
+    void dump(std::ostream& o = std::cerr) const noexcept;
+};
+
+/*--------------------------Bucket methods----------------------------*/
+
+// find Element in Bucket
+// returns index of Element in Bucket, if found, and capacity() otherwise
+// O(N * 2^cls) = O(1)
+template <typename Key, size_t N, size_t Classes>
+typename EH_adaptive_set<Key, N, Classes>::size_type
+EH_adaptive_set<Key, N, Classes>::Bucket::find(const key_type& key) const noexcept {
+    const key_type* k{keys()};
+    for (size_type i{0}; i < arrsz; ++i) {
+        if (key_equal{}(key, k[i])) {
+            return i;
+        }
+    }
+    return capacity();
+}
+
+/*------------------------private methods---------------------*/
+
+// smallest size class that holds n keys, at most the largest one
+// O(Classes)
+template <typename Key, size_t N, size_t Classes>
+typename EH_adaptive_set<Key, N, Classes>::size_type EH_adaptive_set<Key, N, Classes>::fit(size_type n) noexcept {
+    size_type cls{0};
+    while (cls + 1 < Classes && (N << cls) < n) {
+        ++cls;
+    }
+    return cls;
+}
+
+// new empty Bucket of size class cls, terminates if out of memory
+// O(1)
+template <typename Key, size_t N, size_t Classes>
+typename EH_adaptive_set<Key, N, Classes>::Bucket*
+EH_adaptive_set<Key, N, Classes>::allocate(size_type cls) noexcept {
+    void* mem{std::malloc(header + (N << cls) * sizeof(Key))};
+    if (!mem) {
+        std::terminate();
+    }
+    Bucket* b{::new (mem) Bucket{}};
+    b->cls = cls;
+    return b;
+}
+
+// moves the Bucket at directory slot i to size class cls (keeping its keys, which have to fit),
+// realloc usually grows or shrinks it in place, otherwise every pointer to it is redirected. If realloc fails
+// a shrinking Bucket keeps its larger block, a growing one terminates
+// O(1) if in place, O(arrsz + nD / 2^l) otherwise
+template <typename Key, size_t N, size_t Classes>
+void EH_adaptive_set<Key, N, Classes>::resize(size_type i, size_type cls) noexcept {
+    Bucket* b = buckets[i];
+    if (b->cls == cls) {
+        return;
+    }
+    Bucket* moved{static_cast<Bucket*>(std::realloc(static_cast<void*>(b), header + (N << cls) * sizeof(Key)))};
+    if (!moved) {
+        if (cls < b->cls) {
+            return;
+        }
+        std::terminate();
+    }
+    moved->cls = cls;
+    if (moved != b) {
+        for (size_type j{i & (moved->high_bit() - 1)}; j < nD; j += moved->high_bit()) {
+            buckets[j] = moved;
+        }
+    }
+}
+
+// doubles the pointer array
+// O(nD)
+template <typename Key, size_t N, size_t Classes> void EH_adaptive_set<Key, N, Classes>::expansion() noexcept {
+    size_type new_nD = size_type{1} << ++d;
+    Bucket** new_buckets{new Bucket*[new_nD]};
+    for (size_type i{0}; i < nD; ++i) {
+        new_buckets[i] = buckets[i];
+        new_buckets[i + nD] = buckets[i];  // pointer repeat with offset nD
+    }
+    delete[] buckets;
+    buckets = new_buckets;
+    nD = new_nD;
+}
+
+// Split Bucket buckets[hash] by the next hash bit and reassign pointers, both halves get the
+// smallest size class that holds their keys
+// O(N * 2^cls) = O(1)
+template <typename Key, size_t N, size_t Classes>
+void EH_adaptive_set<Key, N, Classes>::split_bucket(size_type hash) noexcept {
+    if (buckets[hash]->l >= d) {  // ensure there is enough space to split
+        expansion();
+    }
+    Bucket* b = buckets[hash];
+    const size_type bit{b->high_bit()};
+    key_type* k{b->keys()};
+    size_type moving{0};
+    for (size_type i{0}; i < b->arrsz; ++i) {
+        moving += (hasher{}(k[i]) & bit) != 0;
+    }
+
+    Bucket* b1{allocate(fit(moving))};  // 1 prefix
+    b1->l = ++b->l;
+    key_type* k1{b1->keys()};
+    size_type kept{0};
+    for (size_type i{0}; i < b->arrsz; ++i) {
+        if (hasher{}(k[i]) & bit) {
+            k1[b1->arrsz++] = k[i];
+        } else {
+            k[kept++] = k[i];
+        }
+    }
+    b->arrsz = kept;
+    ++nB;
+
+    // every second pointer to the original Bucket points to the new one
+    for (size_type first{(hash & (bit - 1)) + bit}; first < nD; first += 2 * bit) {
+        buckets[first] = b1;
+    }
+    resize(hash & (bit - 1), fit(kept));
+}
+
+/*---------------------------EH_adaptive_set methods-----------------------------*/
+
+// create empty set (empty set contains 1 Bucket of the smallest class)
+// O(1)
+template <typename Key, size_t N, size_t Classes>
+EH_adaptive_set<Key, N, Classes>::EH_adaptive_set() noexcept
+    : sz{0}, d{0}, nD{1}, nB{1}, buckets{new Bucket*[nD]} {
+    buckets[0] = allocate(0);
+}
+
+// calls range Constructor
+// O(list size)
+template <typename Key, size_t N, size_t Classes>
+EH_adaptive_set<Key, N, Classes>::EH_adaptive_set(std::initializer_list<key_type> ilist) noexcept
+    : EH_adaptive_set{std::begin(ilist), std::end(ilist)} {}
+
+// calls range insert
+// O(range size)
+template <typename Key, size_t N, size_t Classes>
+template <typename InputIt>
+EH_adaptive_set<Key, N, Classes>::EH_adaptive_set(InputIt first, InputIt last) noexcept : EH_adaptive_set{} {
+    insert(first, last);
+}
+
+// copies directory shape and every Bucket with its size class, no key is rehashed
+// O(other.nD + other.sz)
+template <typename Key, size_t N, size_t Classes>
+EH_adaptive_set<Key, N, Classes>::EH_adaptive_set(const EH_adaptive_set& other) noexcept
+    : sz{other.sz}, d{other.d}, nD{other.nD}, nB{other.nB}, buckets{new Bucket*[nD]} {
+    for (size_type i{0}; i < nD; ++i) {
+        const Bucket* ob = other.buckets[i];
+        if (ob->high_bit() > i) {
+            buckets[i] = allocate(ob->cls);
+            buckets[i]->l = ob->l;
+            buckets[i]->arrsz = ob->arrsz;
+            std::memcpy(static_cast<void*>(buckets[i]->keys()), ob->keys(), ob->arrsz * sizeof(Key));
+        } else {
+            buckets[i] = buckets[i & (ob->high_bit() - 1)];
+        }
+    }
+}
+
+// Destruktor
+// frees every Bucket at its last pointer
+// O(nD)
+template <typename Key, size_t N, size_t Classes> EH_adaptive_set<Key, N, Classes>::~EH_adaptive_set() noexcept {
+    for (size_type i{0}; i < nD; ++i) {
+        if (i >= nD - buckets[i]->high_bit()) {
+            std::free(buckets[i]);
+        }
+    }
+    delete[] buckets;
+}
+
+// copy and swap
+// O(other.nD + other.sz)
+template <typename Key, size_t N, size_t Classes>
+EH_adaptive_set<Key, N, Classes>& EH_adaptive_set<Key, N, Classes>::operator=(const EH_adaptive_set& other) noexcept {
+    if (this != &other) {
+        EH_adaptive_set temp{other};
+        swap(temp);
+    }
+    return *this;
+}
+
+// O(1)
+template <typename Key, size_t N, size_t Classes>
+typename EH_adaptive_set<Key, N, Classes>::size_type EH_adaptive_set<Key, N, Classes>::size() const noexcept {
+    return sz;
+}
+
+// O(1)
+template <typename Key, size_t N, size_t Classes> bool EH_adaptive_set<Key, N, Classes>::empty() const noexcept {
+    return sz == 0;
+}
+
+// global depth of the directory
+// O(1)
+template <typename Key, size_t N, size_t Classes>
+typename EH_adaptive_set<Key, N, Classes>::size_type EH_adaptive_set<Key, N, Classes>::depth() const noexcept {
+    return d;
+}
+
+// number of Buckets
+// O(1)
+template <typename Key, size_t N, size_t Classes>
+typename EH_adaptive_set<Key, N, Classes>::size_type EH_adaptive_set<Key, N, Classes>::bucket_count() const noexcept {
+    return nB;
+}
+
+// number of key slots in all Buckets, the memory they take is slot_count() * sizeof(Key)
+// O(nD)
+template <typename Key, size_t N, size_t Classes>
+typename EH_adaptive_set<Key, N, Classes>::size_type EH_adaptive_set<Key, N, Classes>::slot_count() const noexcept {
+    size_type slots{0};
+    for (size_type i{0}; i < nD; ++i) {
+        if (buckets[i]->high_bit() > i) {
+            slots += buckets[i]->capacity();
+        }
+    }
+    return slots;
+}
+
+// inserts key if it is not inside yet, a full Bucket at global depth grows to the next size class,
+// any other full Bucket is split (doubling the directory for the largest class)
+// returns true if key was inserted
+// O(1)
+template <typename Key, size_t N, size_t Classes>
+bool EH_adaptive_set<Key, N, Classes>::insert(const key_type& key) noexcept {
+    size_type h{hasher{}(key)};
+    size_type hash = h & (nD - 1);
+    if (buckets[hash]->find(key) != buckets[hash]->capacity()) {
+        return false;
+    }
+    while (buckets[hash]->arrsz == buckets[hash]->capacity()) {
+        if (buckets[hash]->l >= d && buckets[hash]->cls + 1 < Classes) {
+            resize(hash, buckets[hash]->cls + 1);
+        } else {
+            split_bucket(hash);
+            hash = h & (nD - 1);
+        }
+    }
+    Bucket* b = buckets[hash];
+    ::new (static_cast<void*>(b->keys() + b->arrsz)) Key(key);
+    ++b->arrsz;
+    ++sz;
+    return true;
+}
+
+// inserts every key of the range
+// O(range size)
+template <typename Key, size_t N, size_t Classes>
+template <typename InputIt>
+void EH_adaptive_set<Key, N, Classes>::insert(InputIt first, InputIt last) noexcept {
+    for (auto it{first}; it != last; ++it) {
+        insert(*it);
+    }
+}
+
+// swap with empty set
+// O(nD)
+template <typename Key, size_t N, size_t Classes> void EH_adaptive_set<Key, N, Classes>::clear() noexcept {
+    EH_adaptive_set temp{};
+    swap(temp);
+}
+
+// overwrites key with the last key of its Bucket, Buckets keep their size class
+// O(1)
+template <typename Key, size_t N, size_t Classes>
+typename EH_adaptive_set<Key, N, Classes>::size_type
+EH_adaptive_set<Key, N, Classes>::erase(const key_type& key) noexcept {
+    Bucket* b = buckets[hasher{}(key) & (nD - 1)];
+    size_type idx{b->find(key)};
+    if (idx == b->capacity()) {
+        return 0;
+    }
+    b->keys()[idx] = b->keys()[--b->arrsz];
+    --sz;
+    return 1;
+}
+
+// hash and call Bucket find
+// O(1)
+template <typename Key, size_t N, size_t Classes>
+typename EH_adaptive_set<Key, N, Classes>::size_type
+EH_adaptive_set<Key, N, Classes>::count(const key_type& key) const noexcept {
+    const Bucket* b = buckets[hasher{}(key) & (nD - 1)];
+    return b->find(key) != b->capacity();
+}
+
+// calls f(key) for every key, f must not modify the set
+// O(nD + sz)
+template <typename Key, size_t N, size_t Classes>
+template <typename F>
+void EH_adaptive_set<Key, N, Classes>::for_each(F f) const noexcept {
+    for (size_type i{0}; i < nD; ++i) {
+        const Bucket* b = buckets[i];
+        if (b->high_bit() > i) {
+            for (size_type j{0}; j < b->arrsz; ++j) {
+                f(b->keys()[j]);
+            }
+        }
+    }
+}
+
+// just uses std::swap for every instance variable
+// O(1)
+template <typename Key, size_t N, size_t Classes>
+void EH_adaptive_set<Key, N, Classes>::swap(EH_adaptive_set& other) noexcept {
+    using std::swap;
+    swap(sz, other.sz);
+    swap(d, other.d);
+    swap(nD, other.nD);
+    swap(nB, other.nB);
+    swap(buckets, other.buckets);
+}
+
+// Outputs entire set to ostream, with the capacity of every Bucket
+template <typename Key, size_t N, size_t Classes>
+void EH_adaptive_set<Key, N, Classes>::dump(std::ostream& o) const noexcept {
+    o << "Adaptive Extendible Hashing <" << typeid(Key).name() << ',' << N << ',' << Classes << ">, d = " << d
+      << ", nD = " << nD << ", nB = " << nB << ", sz = " << sz << '\n';
+    for (size_type i{0}; i < nD; ++i) {
+        const Bucket* b = buckets[i];
+        size_type orig_bucket = i & (b->high_bit() - 1);
+        o << i;
+        if (orig_bucket != i) {
+            o << " ~~> " << orig_bucket;  // if pointer isnt first to a bucket show reference to first Bucket
+        }
+        o << " --> [l = " << b->l << ", capacity = " << b->capacity() << ", arrsz = " << b->arrsz << " | ";
+        for (size_type j{0}; j < b->arrsz; ++j) {
+            o << b->keys()[j] << ' ';
+        }
+        o << "]\n";
+    }
+}
+
+template <typename Key, size_t N, size_t Classes>
+void swap(EH_adaptive_set<Key, N, Classes>& lhs, EH_adaptive_set<Key, N, Classes>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+#endif  // EH_ADAPTIVE_SET_H
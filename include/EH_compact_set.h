@@ -0,0 +1,886 @@
+#ifndef EH_COMPACT_SET_H
+#define EH_COMPACT_SET_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+// Extendible Hashing Set for small, trivially copyable keys (e.g. 32-bit IDs).
+// Same interface and behaviour as EH_set, but
+//  - the directory stores 32-bit Bucket indices instead of Bucket pointers
+//  - all Buckets live in one contiguous array, grown with realloc
+//  - local depth and Bucket size use the narrowest type that fits
+// which halves the directory and removes the padding behind every Bucket.
+// Since no pointers are stored, save writes directory and Buckets as they are and load reads them back
+// without rehashing. EH_compact_view looks up in such an image in place (e.g. in a mapped file).
+// With Filter = true every Bucket gets a blocked Bloom filter (8 bits per key slot) in an array next to the
+// directory, which count and find check first, so most misses never touch the Buckets (e.g. pages of a mapped
+// image that are not in memory). insert sets the bits of a key, split_bucket rebuilds the filters of both
+// halves, erase leaves them (a stale bit only costs a scan).
+template <typename Key, size_t N, bool Filter> class EH_compact_view;
+
+template <typename Key, size_t N = 16, bool Filter = false> class EH_compact_set {
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_default_constructible_v<Key>,
+                  "EH_compact_set needs trivial keys, use EH_set instead");
+    static_assert(N > 0 && N <= UINT32_MAX, "Bucket size out of range");
+
+  public:
+    class Iterator;
+    using value_type = Key;
+    using key_type = Key;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using const_iterator = Iterator;
+    using iterator = const_iterator;
+    using key_equal = std::equal_to<key_type>;
+    using hasher = std::hash<key_type>;
+
+  private:
+    using index_type = std::uint32_t;  // Bucket index in directory
+    using count_type =
+        std::conditional_t<(N <= UINT8_MAX), std::uint8_t,
+                           std::conditional_t<(N <= UINT16_MAX), std::uint16_t, std::uint32_t>>;
+
+    struct Bucket {
+        key_type elements[N];
+        std::uint8_t l;    // local depth
+        count_type arrsz;  // number of elems in Bucket
+
+        size_type append(const key_type& elem) noexcept;
+        size_type remove(const key_type& elem) noexcept;
+        [[nodiscard]] size_type find(const key_type& elem) const noexcept;
+        [[nodiscard]] inline size_type high_bit() const noexcept;
+    };
+
+    // 64-bit words of the Bloom filter of a Bucket, a key sets 3 bits in one of them
+    static constexpr size_type filter_words{Filter ? (N + 7) / 8 : 0};
+
+    // word of the filter and bits in it that a key with hash sets
+    struct filter_probe {
+        size_type word;
+        std::uint64_t bits;
+    };
+
+    friend class EH_compact_view<Key, N, Filter>;
+
+    // start of the image written by save, followed by the directory, the Buckets at pool_offset and the
+    // filters at filter_offset
+    struct Image {
+        char magic[4];
+        std::uint32_t key_size;
+        std::uint32_t n;
+        std::uint32_t d;
+        index_type nB;
+        std::uint32_t filter;  // filter_words, 0 in images without filters
+        std::uint64_t sz;
+
+        static constexpr char expected[4]{'E', 'H', 'C', '1'};
+
+        [[nodiscard]] bool valid() const noexcept {
+            return std::equal(magic, magic + 4, expected) && key_size == sizeof(Key) && n == N && d < 32 &&
+                   nB > 0 && filter == filter_words;
+        }
+        [[nodiscard]] size_type pool_offset() const noexcept {
+            size_type end{sizeof(Image) + (size_type{1} << d) * sizeof(index_type)};
+            return (end + alignof(Bucket) - 1) / alignof(Bucket) * alignof(Bucket);
+        }
+        [[nodiscard]] size_type filter_offset() const noexcept {
+            size_type end{pool_offset() + size_type{nB} * sizeof(Bucket)};
+            return (end + alignof(std::uint64_t) - 1) / alignof(std::uint64_t) * alignof(std::uint64_t);
+        }
+        [[nodiscard]] size_type bytes() const noexcept {
+            return Filter ? filter_offset() + size_type{nB} * filter_words * sizeof(std::uint64_t)
+                          : pool_offset() + size_type{nB} * sizeof(Bucket);
+        }
+    };
+
+    size_type sz;           // actual size
+    size_type d;            // global depth
+    size_type nD;           // 2^d
+    index_type nB;          // number of Buckets in use
+    index_type cap;         // number of Buckets allocated
+    index_type* dir;        // directory
+    Bucket* pool;           // all Buckets, contiguous
+    std::uint64_t* filter;  // filter_words per Bucket, nullptr without Filter
+
+    void expansion() noexcept;
+    void split_bucket(size_type hash) noexcept;
+    index_type new_bucket(std::uint8_t l) noexcept;
+    iterator add(key_type k, bool check = true) noexcept;
+
+    [[nodiscard]] Bucket& bucket(size_type i) noexcept { return pool[dir[i]]; }
+    [[nodiscard]] const Bucket& bucket(size_type i) const noexcept { return pool[dir[i]]; }
+
+    [[nodiscard]] static filter_probe probe(size_type hash) noexcept;
+    [[nodiscard]] static bool may_contain(const std::uint64_t* filters, index_type b, size_type hash) noexcept;
+    void filter_add(index_type b, size_type hash) noexcept;
+
+    // realloc that terminates (like new in a noexcept context) on failure
+    template <typename T> static T* grow(T* p, size_type n) noexcept {
+        void* res{std::realloc(p, n * sizeof(T))};
+        if (!res) {
+            std::terminate();
+        }
+        return static_cast<T*>(res);
+    }
+
+    // reads n Ts from in into p, growing p (at most doubling) only once the bytes before arrived, so a corrupt
+    // count fails on the missing bytes instead of exhausting memory. Returns false if in fails or realloc fails,
+    // p stays valid (and owned by the caller) either way
+    template <typename T> static bool read_grown(std::istream& in, T*& p, size_type n) noexcept {
+        for (size_type done{0}; done < n;) {
+            size_type step{std::min(n - done, std::max<size_type>(done, 4096))};
+            void* res{std::realloc(p, (done + step) * sizeof(T))};
+            if (!res) {
+                return false;
+            }
+            p = static_cast<T*>(res);
+            if (!in.read(reinterpret_cast<char*>(p + done), static_cast<std::streamsize>(step * sizeof(T)))) {
+                return false;
+            }
+            done += step;
+        }
+        return true;
+    }
+
+  public:
+    EH_compact_set() noexcept;
+    EH_compact_set(std::initializer_list<key_type> ilist) noexcept;
+    template <typename InputIt> EH_compact_set(InputIt first, InputIt last) noexcept;
+    EH_compact_set(const EH_compact_set& other) noexcept;
+
+    ~EH_compact_set() noexcept;
+
+    EH_compact_set& operator=(const EH_compact_set& other) noexcept;
+    EH_compact_set& operator=(std::initializer_list<key_type> ilist) noexcept;
+
+    [[nodiscard]] size_type size() const noexcept;
+    [[nodiscard]] bool empty() const noexcept;
+
+    void insert(std::initializer_list<key_type> ilist) noexcept;
+    std::pair<iterator, bool> insert(const key_type& key) noexcept;
+    template <typename InputIt> void insert(InputIt first, InputIt last) noexcept;
+
+    void clear() noexcept;
+
+    size_type erase(const key_type& key) noexcept;
+    [[nodiscard]] size_type count(const key_type& key) const noexcept;
+    [[nodiscard]] iterator find(const key_type& key) const noexcept;
+
+    void swap(EH_compact_set& other) noexcept;
+
+    [[nodiscard]] const_iterator begin() const noexcept;
+    [[nodiscard]] const_iterator end() const noexcept;
+
+    // bytes used by directory and Buckets
+    [[nodiscard]] size_type memory_usage() const noexcept;
+
+    void dump(std::ostream& o = std::cerr) const noexcept;
+    bool save(std::ostream& o) const noexcept;
+    bool load(std::istream& in) noexcept;
+
+    // goes through every key in lhs once and calls count for rhs
+    // O(lhs.sz)
+    [[nodiscard]] friend bool operator==(const EH_compact_set& lhs, const EH_compact_set& rhs) noexcept {
+        if (lhs.sz != rhs.sz) {
+            return false;
+        }
+        for (const auto& key : rhs) {
+            if (!lhs.count(key)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+    [[nodiscard]] friend bool operator!=(const EH_compact_set& lhs, const EH_compact_set& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+};
+
+/*--------------------------Bucket methods----------------------------*/
+
+// Append Element to Bucket
+// returns 1 if Element could be inserted, 0 otherwise
+// O(1)
+template <typename Key, size_t N, bool Filter>
+typename EH_compact_set<Key, N, Filter>::size_type
+EH_compact_set<Key, N, Filter>::Bucket::append(const key_type& elem) noexcept {
+    if (arrsz == N) {
+        return 0;
+    }
+    elements[arrsz++] = elem;
+    return 1;
+}
+
+// find Element in Bucket
+// returns index of Element in Bucket, if found, and N otherwise
+// O(N) = O(1)
+template <typename Key, size_t N, bool Filter>
+typename EH_compact_set<Key, N, Filter>::size_type
+EH_compact_set<Key, N, Filter>::Bucket::find(const key_type& elem) const noexcept {
+    for (size_type i{0}; i < arrsz; ++i) {
+        if (key_equal{}(elem, elements[i])) {
+            return i;
+        }
+    }
+    return N;
+}
+
+// Remove Element in Bucket
+// overwrite with last element and decrease size
+// O(N) = O(1)
+template <typename Key, size_t N, bool Filter>
+typename EH_compact_set<Key, N, Filter>::size_type
+EH_compact_set<Key, N, Filter>::Bucket::remove(const key_type& elem) noexcept {
+    size_type i{find(elem)};
+    if (i == N) {
+        return 0;
+    }
+    elements[i] = elements[--arrsz];
+    return 1;
+}
+
+// returns highest bit that bucket elems agree on
+template <typename Key, size_t N, bool Filter>
+inline typename EH_compact_set<Key, N, Filter>::size_type
+EH_compact_set<Key, N, Filter>::Bucket::high_bit() const noexcept {
+    return size_type{1} << l;
+}
+
+/*------------------------private methods---------------------*/
+
+// May call expansion and split multiple times
+// O(1)
+template <typename Key, size_t N, bool Filter>
+typename EH_compact_set<Key, N, Filter>::iterator EH_compact_set<Key, N, Filter>::add(key_type k, bool check) noexcept {
+    size_type full{hasher{}(k)};
+    size_type hash = full & (nD - 1);
+    size_type idx{0};
+    if (check && may_contain(filter, dir[hash], full) && (idx = bucket(hash).find(k)) != N) {
+        return iterator(idx, hash, this);  // if already inside, skip
+    }
+
+    while (true) {  // while key can't be inserted
+        if (bucket(hash).append(k)) {
+            sz++;  // successful insert
+            filter_add(dir[hash], full);
+            return iterator(bucket(hash).arrsz - 1, hash, this);
+        }
+        // bucket overflow, split (and expansion) necessary
+        split_bucket(hash);
+        hash = full & (nD - 1);
+    }
+}
+
+// append an empty Bucket to the pool, doubling the pool if it is full (up to the largest index_type)
+// returns the index of the new Bucket, terminates if every index_type is taken
+// amortized O(1)
+template <typename Key, size_t N, bool Filter>
+typename EH_compact_set<Key, N, Filter>::index_type
+EH_compact_set<Key, N, Filter>::new_bucket(std::uint8_t l) noexcept {
+    if (nB == cap) {
+        constexpr index_type max_cap{std::numeric_limits<index_type>::max()};
+        if (cap == max_cap) {
+            std::terminate();
+        }
+        cap = cap == 0 ? 1 : cap > max_cap / 2 ? max_cap : cap * 2;
+        pool = grow(pool, cap);
+        if constexpr (Filter) {
+            filter = grow(filter, size_type{cap} * filter_words);
+        }
+    }
+    pool[nB].l = l;
+    pool[nB].arrsz = 0;
+    if constexpr (Filter) {
+        std::fill_n(filter + size_type{nB} * filter_words, filter_words, 0);
+    }
+    return nB++;
+}
+
+// mixes hash (its low bits already picked the Bucket) and takes a word of the filter and 3 bits in it
+// O(1)
+template <typename Key, size_t N, bool Filter>
+typename EH_compact_set<Key, N, Filter>::filter_probe EH_compact_set<Key, N, Filter>::probe(size_type hash) noexcept {
+    std::uint64_t h{hash};
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111eb;
+    h ^= h >> 31;
+    return {static_cast<size_type>((h >> 32) * filter_words >> 32),
+            std::uint64_t{1} << (h & 63) | std::uint64_t{1} << (h >> 6 & 63) | std::uint64_t{1} << (h >> 12 & 63)};
+}
+
+// false if the filter of Bucket b rules out a key with hash, always true without Filter
+// static, so EH_compact_view checks the filters of an image the same way
+// O(1)
+template <typename Key, size_t N, bool Filter>
+bool EH_compact_set<Key, N, Filter>::may_contain(const std::uint64_t* filters, index_type b, size_type hash) noexcept {
+    if constexpr (Filter) {
+        filter_probe p{probe(hash)};
+        return (filters[size_type{b} * filter_words + p.word] & p.bits) == p.bits;
+    }
+    return true;
+}
+
+// sets the bits of a key with hash in the filter of Bucket b
+// O(1)
+template <typename Key, size_t N, bool Filter>
+void EH_compact_set<Key, N, Filter>::filter_add(index_type b, size_type hash) noexcept {
+    if constexpr (Filter) {
+        filter_probe p{probe(hash)};
+        filter[size_type{b} * filter_words + p.word] |= p.bits;
+    }
+}
+
+// doubles the index array
+// O(nD)
+template <typename Key, size_t N, bool Filter> void EH_compact_set<Key, N, Filter>::expansion() noexcept {
+    ++d;
+    dir = grow(dir, nD * 2);
+    std::memcpy(dir + nD, dir, nD * sizeof(index_type));  // index repeat with offset nD
+    nD *= 2;
+}
+
+// Split Bucket at dir[hash] and reassign indices
+// O(N) = O(1)
+template <typename Key, size_t N, bool Filter>
+void EH_compact_set<Key, N, Filter>::split_bucket(size_type hash) noexcept {
+    if (bucket(hash).l >= d) {  // ensure there is enough space to split
+        expansion();
+    }
+    index_type orig{dir[hash]};
+    index_type other{new_bucket(pool[orig].l + 1)};  // may move the pool, so only hold indices before
+    Bucket& b = pool[orig];
+    Bucket& b1 = pool[other];  // 1 prefix
+    ++b.l;
+
+    // rehash every Element from original Bucket, compacting the ones that stay, and rebuild both filters
+    count_type n{b.arrsz};
+    b.arrsz = 0;
+    if constexpr (Filter) {
+        std::fill_n(filter + size_type{orig} * filter_words, filter_words, 0);
+    }
+    for (size_type i{0}; i < n; ++i) {
+        size_type h{hasher{}(b.elements[i])};
+        if (h >> (b.l - 1) & 1) {
+            b1.append(b.elements[i]);
+            filter_add(other, h);
+        } else {
+            b.append(b.elements[i]);
+            filter_add(orig, h);
+        }
+    }
+
+    // assign every index that should point to new Bucket (see EH_set::split_bucket)
+    size_type offset{size_type{1} << (b.l - 1)};
+    size_type first{(hash & (offset - 1)) + offset};
+    offset += offset;
+
+    for (; first < nD; first += offset) {
+        dir[first] = other;
+    }
+}
+
+/*---------------------------EH_compact_set methods-----------------------------*/
+
+// create empty set (empty set contains 1 Bucket)
+// O(1)
+template <typename Key, size_t N, bool Filter>
+EH_compact_set<Key, N, Filter>::EH_compact_set() noexcept
+    : sz{0}, d{0}, nD{1}, nB{0}, cap{0}, dir{grow<index_type>(nullptr, 1)}, pool{nullptr}, filter{nullptr} {
+    dir[0] = new_bucket(0);
+}
+
+// calls it Constructor
+// O(list size)
+template <typename Key, size_t N, bool Filter>
+EH_compact_set<Key, N, Filter>::EH_compact_set(std::initializer_list<key_type> ilist) noexcept
+    : EH_compact_set{std::begin(ilist), std::end(ilist)} {}
+
+// calls list insert
+// O(it range)
+template <typename Key, size_t N, bool Filter>
+template <typename InputIt>
+EH_compact_set<Key, N, Filter>::EH_compact_set(InputIt first, InputIt last) noexcept : EH_compact_set{} {
+    insert(first, last);
+}
+
+// copies directory, Buckets and filters as raw memory, the indices stay valid
+// O(other.nD + other.nB)
+template <typename Key, size_t N, bool Filter>
+EH_compact_set<Key, N, Filter>::EH_compact_set(const EH_compact_set& other) noexcept
+    : sz{other.sz}, d{other.d}, nD{other.nD}, nB{other.nB}, cap{other.nB}, dir{grow<index_type>(nullptr, nD)},
+      pool{grow<Bucket>(nullptr, nB)}, filter{nullptr} {
+    std::memcpy(dir, other.dir, nD * sizeof(index_type));
+    std::memcpy(pool, other.pool, nB * sizeof(Bucket));
+    if constexpr (Filter) {
+        filter = grow<std::uint64_t>(nullptr, size_type{nB} * filter_words);
+        std::memcpy(filter, other.filter, size_type{nB} * filter_words * sizeof(std::uint64_t));
+    }
+}
+
+// Destruktor
+// Buckets are not referenced individually, so just free the arrays
+// O(1)
+template <typename Key, size_t N, bool Filter> EH_compact_set<Key, N, Filter>::~EH_compact_set() noexcept {
+    std::free(dir);
+    std::free(pool);
+    std::free(filter);
+}
+
+// copy and swap
+// O(other.nD + other.nB)
+template <typename Key, size_t N, bool Filter>
+EH_compact_set<Key, N, Filter>& EH_compact_set<Key, N, Filter>::operator=(const EH_compact_set& other) noexcept {
+    if (this != &other) {
+        EH_compact_set temp{other};
+        swap(temp);
+    }
+    return *this;
+}
+
+// clears all values, without losing structur and inserts ilist
+// O(nB + list size)
+template <typename Key, size_t N, bool Filter>
+EH_compact_set<Key, N, Filter>&
+EH_compact_set<Key, N, Filter>::operator=(std::initializer_list<key_type> ilist) noexcept {
+    for (index_type i{0}; i < nB; ++i) {
+        pool[i].arrsz = 0;
+    }
+    if constexpr (Filter) {
+        std::fill_n(filter, size_type{nB} * filter_words, 0);
+    }
+    sz = 0;
+    insert(ilist);
+    return *this;
+}
+
+// O(1)
+template <typename Key, size_t N, bool Filter>
+typename EH_compact_set<Key, N, Filter>::size_type EH_compact_set<Key, N, Filter>::size() const noexcept {
+    return sz;
+}
+// O(1)
+template <typename Key, size_t N, bool Filter>
+bool EH_compact_set<Key, N, Filter>::empty() const noexcept { return (sz == 0); }
+
+// insert list: calls iterator insert
+// O(list size)
+template <typename Key, size_t N, bool Filter>
+void EH_compact_set<Key, N, Filter>::insert(std::initializer_list<key_type> ilist) noexcept {
+    insert(std::begin(ilist), std::end(ilist));
+}
+
+// calls private method add
+// O(1)
+template <typename Key, size_t N, bool Filter>
+std::pair<typename EH_compact_set<Key, N, Filter>::iterator, bool>
+EH_compact_set<Key, N, Filter>::insert(const key_type& key) noexcept {
+    size_type old_sz{sz};
+    return {add(key), (old_sz != sz)};
+}
+
+// iterator insert calls private method add for every item
+// O(range size)
+template <typename Key, size_t N, bool Filter>
+template <typename InputIt>
+void EH_compact_set<Key, N, Filter>::insert(InputIt first, InputIt last) noexcept {
+    for (auto it{first}; it != last; ++it) {
+        add(*it);
+    }
+}
+
+// swap with empty set
+// O(1)
+template <typename Key, size_t N, bool Filter> void EH_compact_set<Key, N, Filter>::clear() noexcept {
+    EH_compact_set temp{};
+    swap(temp);
+}
+
+// hash and call Bucket remove
+// O(1)
+template <typename Key, size_t N, bool Filter>
+typename EH_compact_set<Key, N, Filter>::size_type EH_compact_set<Key, N, Filter>::erase(const key_type& key) noexcept {
+    if (bucket(hasher{}(key) & (nD - 1)).remove(key)) {  // the filter keeps the bits of key
+        --sz;
+        return 1;
+    }
+    return 0;
+}
+
+// hash, check the filter and call Bucket find
+// O(1)
+template <typename Key, size_t N, bool Filter>
+typename EH_compact_set<Key, N, Filter>::size_type
+EH_compact_set<Key, N, Filter>::count(const key_type& key) const noexcept {
+    size_type full{hasher{}(key)};
+    size_type hash{full & (nD - 1)};
+    return may_contain(filter, dir[hash], full) && bucket(hash).find(key) != N;
+}
+
+// hash, check the filter and call Bucket find
+// O(1)
+template <typename Key, size_t N, bool Filter>
+typename EH_compact_set<Key, N, Filter>::iterator
+EH_compact_set<Key, N, Filter>::find(const key_type& key) const noexcept {
+    size_type full{hasher{}(key)};
+    size_type hash{full & (nD - 1)};
+    if (!may_contain(filter, dir[hash], full)) {
+        return end();
+    }
+    size_type idx{bucket(hash).find(key)};
+    return idx != N ? iterator(idx, hash, this) : end();
+}
+
+// just uses std::swap for every instance variable
+// O(1)
+template <typename Key, size_t N, bool Filter>
+void EH_compact_set<Key, N, Filter>::swap(EH_compact_set& other) noexcept {
+    using std::swap;
+    swap(sz, other.sz);
+    swap(d, other.d);
+    swap(nD, other.nD);
+    swap(nB, other.nB);
+    swap(cap, other.cap);
+    swap(dir, other.dir);
+    swap(pool, other.pool);
+    swap(filter, other.filter);
+}
+
+// begin-iterator is first element of first Bucket
+// O(1)
+template <typename Key, size_t N, bool Filter>
+typename EH_compact_set<Key, N, Filter>::const_iterator EH_compact_set<Key, N, Filter>::begin() const noexcept {
+    return const_iterator(0, 0, this);
+}
+// end-iterator is first element of (nonexistent) nDth Bucket
+// O(1)
+template <typename Key, size_t N, bool Filter>
+typename EH_compact_set<Key, N, Filter>::const_iterator EH_compact_set<Key, N, Filter>::end() const noexcept {
+    return const_iterator(this);
+}
+
+// O(1)
+template <typename Key, size_t N, bool Filter>
+typename EH_compact_set<Key, N, Filter>::size_type EH_compact_set<Key, N, Filter>::memory_usage() const noexcept {
+    return sizeof(*this) + nD * sizeof(index_type) + cap * (sizeof(Bucket) + filter_words * sizeof(std::uint64_t));
+}
+
+// Outputs entire set to ostream, same format as EH_set::dump
+template <typename Key, size_t N, bool Filter>
+void EH_compact_set<Key, N, Filter>::dump(std::ostream& o) const noexcept {
+    o << "Extendible Hashing (compact) <" << typeid(Key).name() << ',' << N << ">, d = " << d << ", nD = " << nD
+      << ", sz = " << sz << ", nB = " << nB << '\n';
+    for (size_type i{0}; i < nD; ++i) {
+        const Bucket& b = bucket(i);
+        size_type orig_bucket = i & (b.high_bit() - 1);
+        o << i;
+        if (orig_bucket != i) {
+            o << " ~~> " << orig_bucket;
+        }
+        o << " --> [l = " << +b.l << ", offset = " << b.high_bit() << ", arrsz = " << +b.arrsz << " | ";
+        for (size_type j{0}; j < b.arrsz; ++j) {
+            o << b.elements[j] << ' ';
+        }
+        o << "]\n";
+    }
+}
+
+// writes the set as image, in host byte order: header (see Image), the directory, padding up to the
+// alignment of Bucket and the Buckets in use, all as they are in memory, and with Filter padding up to 8 bytes
+// and the filters of the Buckets in use
+// returns false if o failed
+// O(nD + nB)
+template <typename Key, size_t N, bool Filter>
+bool EH_compact_set<Key, N, Filter>::save(std::ostream& o) const noexcept {
+    Image image{};
+    std::copy(Image::expected, Image::expected + 4, image.magic);
+    image.key_size = sizeof(Key);
+    image.n = N;
+    image.d = static_cast<std::uint32_t>(d);
+    image.nB = nB;
+    image.filter = filter_words;
+    image.sz = sz;
+    o.write(reinterpret_cast<const char*>(&image), sizeof(image));
+    o.write(reinterpret_cast<const char*>(dir), static_cast<std::streamsize>(nD * sizeof(index_type)));
+    for (size_type i{sizeof(Image) + nD * sizeof(index_type)}; i < image.pool_offset(); ++i) {
+        o.put('\0');
+    }
+    o.write(reinterpret_cast<const char*>(pool), static_cast<std::streamsize>(nB * sizeof(Bucket)));
+    if constexpr (Filter) {
+        for (size_type i{image.pool_offset() + nB * sizeof(Bucket)}; i < image.filter_offset(); ++i) {
+            o.put('\0');
+        }
+        o.write(reinterpret_cast<const char*>(filter),
+                static_cast<std::streamsize>(nB * filter_words * sizeof(std::uint64_t)));
+    }
+    return o.good();
+}
+
+// reads an image written by save, without moving any key. Directory, Buckets and filters are grown while they
+// are read, so a corrupt header fails on the missing bytes. Every Bucket has to own exactly the directory slots
+// congruent to its first one mod 2^l and hold only keys that hash there, otherwise lookups would miss or read
+// out of bounds and the next split would corrupt the directory
+// returns false and leaves the set unchanged if in does not hold a valid image of this Key, N and Filter
+// O(nD + nB + sz)
+template <typename Key, size_t N, bool Filter> bool EH_compact_set<Key, N, Filter>::load(std::istream& in) noexcept {
+    Image image{};
+    if (!in.read(reinterpret_cast<char*>(&image), sizeof(image)) || !image.valid()) {
+        return false;
+    }
+    EH_compact_set temp{};
+    temp.nB = 0;  // the Buckets read below replace the one of the empty set
+    bool ok{read_grown(in, temp.dir, size_type{1} << image.d) &&
+            in.ignore(static_cast<std::streamsize>(image.pool_offset() - sizeof(Image) -
+                                                   (size_type{1} << image.d) * sizeof(index_type))) &&
+            read_grown(in, temp.pool, image.nB)};
+    if constexpr (Filter) {
+        ok = ok &&
+             in.ignore(static_cast<std::streamsize>(image.filter_offset() - image.pool_offset() -
+                                                    image.nB * sizeof(Bucket))) &&
+             read_grown(in, temp.filter, size_type{image.nB} * filter_words);
+    }
+    if (!ok) {
+        return false;
+    }
+    temp.d = image.d;
+    temp.nD = size_type{1} << image.d;
+    temp.nB = image.nB;
+    temp.cap = image.nB;
+
+    size_type keys{0};
+    for (index_type i{0}; ok && i < temp.nB; ++i) {
+        ok = temp.pool[i].l <= temp.d && temp.pool[i].arrsz <= N;
+        keys += temp.pool[i].arrsz;
+    }
+    for (size_type i{0}; ok && i < temp.nD; ++i) {
+        ok = temp.dir[i] < temp.nB;
+    }
+    if (!ok || keys != image.sz) {
+        return false;
+    }
+
+    // the first slot of a Bucket is below its high_bit, it has to be the only one seen for the Bucket and every
+    // slot congruent to it has to point to the Bucket. Slots past the high_bit then point to Buckets seen before
+    std::uint8_t* seen{static_cast<std::uint8_t*>(std::calloc(temp.nB, 1))};
+    ok = seen != nullptr;
+    index_type unique{0};
+    for (size_type i{0}; ok && i < temp.nD; ++i) {
+        index_type b{temp.dir[i]};
+        size_type high{temp.pool[b].high_bit()};
+        if (i >= high) {
+            ok = temp.dir[i & (high - 1)] == b;
+            continue;
+        }
+        ok = !seen[b];
+        seen[b] = 1;
+        ++unique;
+        for (size_type j{i + high}; ok && j < temp.nD; j += high) {
+            ok = temp.dir[j] == b;
+        }
+        for (size_type k{0}; ok && k < temp.pool[b].arrsz; ++k) {
+            ok = (hasher{}(temp.pool[b].elements[k]) & (high - 1)) == i;
+        }
+    }
+    std::free(seen);
+    if (!ok || unique != temp.nB) {
+        return false;  // a Bucket that no slot points to
+    }
+    temp.sz = keys;
+    swap(temp);
+    return true;
+}
+
+/*---------------------------Iterator Class-------------------------------*/
+
+template <typename Key, size_t N, bool Filter> class EH_compact_set<Key, N, Filter>::Iterator {
+  public:
+    using value_type = Key;
+    using difference_type = std::ptrdiff_t;
+    using reference = const value_type&;
+    using pointer = const value_type*;
+    using iterator_category = std::forward_iterator_tag;
+
+  private:
+    size_type idx{0};
+    const EH_compact_set* set{nullptr};
+    size_type b{0};
+
+    // skip to the next, first index, that is the first occurence, to point to a
+    // non-empty Bucket
+    void skip() noexcept {
+        while (b >= set->bucket(b).high_bit() || set->bucket(b).arrsz == 0) {
+            b++;
+            if (is_end()) {
+                break;
+            }
+        }
+    }
+
+    [[nodiscard]] bool is_end() const noexcept { return b == set->nD; }
+
+    [[nodiscard]] pointer ptr() const noexcept { return &set->bucket(b).elements[idx]; }
+
+  public:
+    explicit Iterator(size_type idx, size_type b, const EH_compact_set* set) noexcept
+        : idx{idx}, set{set}, b{b & (set->bucket(b).high_bit() - 1)} {
+        skip();
+    }
+
+    Iterator(const EH_compact_set* set) noexcept : idx{0}, set{set}, b{set->nD} {}  // for end-iterator
+    Iterator() noexcept : idx{0}, set{nullptr}, b{0} {}
+
+    [[nodiscard]] reference operator*() const noexcept { return *ptr(); }
+    [[nodiscard]] pointer operator->() const noexcept { return ptr(); }
+
+    Iterator& operator++() noexcept {
+        if (++idx < set->bucket(b).arrsz) {
+            return *this;
+        }
+
+        idx = 0;
+        ++b;
+        if (b != set->nD) {
+            skip();
+        }
+        return *this;
+    }
+
+    Iterator operator++(int) noexcept {
+        auto temp{*this};
+        ++(*this);
+        return temp;
+    }
+
+    // returns current position of iterator in format {Bucket number, Index in
+    // Bucker}, for debugging
+    std::pair<unsigned, unsigned> get_pos() const noexcept { return {b, idx}; }
+
+    [[nodiscard]] friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+        if (lhs.is_end() || rhs.is_end()) {
+            return lhs.is_end() && rhs.is_end();
+        }
+        return (lhs.ptr() == rhs.ptr());
+    }
+    [[nodiscard]] friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept { return !(lhs == rhs); }
+};
+
+template <typename Key, size_t N, bool Filter>
+void swap(EH_compact_set<Key, N, Filter>& lhs, EH_compact_set<Key, N, Filter>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+/*---------------------------EH_compact_view-------------------------------*/
+
+// read only EH_compact_set on an image written by EH_compact_set::save, without copying it.
+// The image has to stay alive and unchanged while the view is used. Only the header and the directory are
+// checked up front, Buckets are only touched by the lookups that need them (with Filter, only by the lookups
+// that pass the filter of their Bucket).
+template <typename Key, size_t N = 16, bool Filter = false> class EH_compact_view {
+    using set_type = EH_compact_set<Key, N, Filter>;
+    using Image = typename set_type::Image;
+    using Bucket = typename set_type::Bucket;
+    using index_type = typename set_type::index_type;
+
+  public:
+    using key_type = Key;
+    using size_type = size_t;
+    using key_equal = typename set_type::key_equal;
+    using hasher = typename set_type::hasher;
+
+  private:
+    static constexpr size_type alignment{Filter ? std::max(alignof(Bucket), alignof(std::uint64_t))
+                                                : alignof(Bucket)};
+
+    const index_type* dir{nullptr};
+    const Bucket* pool{nullptr};
+    const std::uint64_t* filter{nullptr};
+    size_type sz{0};
+    size_type nD{0};
+
+  public:
+    EH_compact_view() noexcept = default;
+    EH_compact_view(const void* data, size_type bytes) noexcept;
+
+    [[nodiscard]] bool valid() const noexcept;
+    [[nodiscard]] size_type size() const noexcept;
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_type count(const key_type& key) const noexcept;
+};
+
+// checks header and directory of the image at data (aligned like the Buckets and the filters), the view is
+// not valid if anything does not fit
+// O(nD)
+template <typename Key, size_t N, bool Filter>
+EH_compact_view<Key, N, Filter>::EH_compact_view(const void* data, size_type bytes) noexcept {
+    const Image* image{static_cast<const Image*>(data)};
+    if (reinterpret_cast<std::uintptr_t>(data) % alignment != 0 || bytes < sizeof(Image) ||
+        !image->valid() || bytes < image->bytes()) {
+        return;
+    }
+    const char* base{static_cast<const char*>(data)};
+    const index_type* d{reinterpret_cast<const index_type*>(base + sizeof(Image))};
+    size_type n{size_type{1} << image->d};
+    for (size_type i{0}; i < n; ++i) {
+        if (d[i] >= image->nB) {
+            return;
+        }
+    }
+    dir = d;
+    pool = reinterpret_cast<const Bucket*>(base + image->pool_offset());
+    if constexpr (Filter) {
+        filter = reinterpret_cast<const std::uint64_t*>(base + image->filter_offset());
+    }
+    sz = image->sz;
+    nD = n;
+}
+
+// O(1)
+template <typename Key, size_t N, bool Filter>
+bool EH_compact_view<Key, N, Filter>::valid() const noexcept { return dir != nullptr; }
+
+// O(1)
+template <typename Key, size_t N, bool Filter>
+typename EH_compact_view<Key, N, Filter>::size_type EH_compact_view<Key, N, Filter>::size() const noexcept {
+    return sz;
+}
+
+// O(1)
+template <typename Key, size_t N, bool Filter>
+bool EH_compact_view<Key, N, Filter>::empty() const noexcept { return sz == 0; }
+
+// like EH_compact_set::count (filter first), the Bucket size is clamped to N since Buckets are not checked
+// up front
+// O(1)
+template <typename Key, size_t N, bool Filter>
+typename EH_compact_view<Key, N, Filter>::size_type
+EH_compact_view<Key, N, Filter>::count(const key_type& key) const noexcept {
+    if (!dir) {
+        return 0;
+    }
+    size_type hash{hasher{}(key)};
+    index_type bi{dir[hash & (nD - 1)]};
+    if (!set_type::may_contain(filter, bi, hash)) {
+        return 0;
+    }
+    const Bucket& b = pool[bi];
+    size_type n{std::min<size_type>(b.arrsz, N)};
+    for (size_type i{0}; i < n; ++i) {
+        if (key_equal{}(key, b.elements[i])) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#endif  // EH_COMPACT_SET_H
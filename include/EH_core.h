@@ -0,0 +1,1218 @@
+#ifndef EH_CORE_H
+#define EH_CORE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(DEBUG)
+#define TRACE(x) std::cerr << x << std::endl;
+#else
+#define TRACE(x)
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH(x) __builtin_prefetch(x)
+#else
+#define PREFETCH(x)
+#endif
+
+// Split policies. A policy provides
+//  - spare: slots of a Bucket (out of Slots::capacity) that are only used instead of a split that would
+//    double the directory. The next key for the overflowing Bucket splits it
+//  - split_early(arrsz, full): whether a Bucket with arrsz of its full = capacity - spare slots used should
+//    be split before it takes another key, at most one such split is done per insert
+// Lookups scan all arrsz keys of a Bucket, so splitting early trades memory for shorter scans.
+
+// splits a Bucket only when it is full (default)
+struct EH_split_on_overflow {
+    static constexpr size_t spare{0};
+    [[nodiscard]] static constexpr bool split_early(size_t, size_t) noexcept { return false; }
+};
+
+// splits a Bucket once it is Percent full
+template <size_t Percent> struct EH_split_at_fill {
+    static_assert(Percent > 0 && Percent <= 100, "fill ratio out of range");
+    static constexpr size_t spare{0};
+    [[nodiscard]] static constexpr bool split_early(size_t arrsz, size_t full) noexcept {
+        return arrsz * 100 >= full * Percent;
+    }
+};
+
+// splits a Bucket once a lookup that misses would compare Keys keys
+template <size_t Keys> struct EH_split_at_probe {
+    static_assert(Keys > 0, "probe length out of range");
+    static constexpr size_t spare{0};
+    [[nodiscard]] static constexpr bool split_early(size_t arrsz, size_t) noexcept { return arrsz >= Keys; }
+};
+
+// defers a split that would double the directory by one key, a Bucket holds N + 1 keys then
+struct EH_split_deferred {
+    static constexpr size_t spare{1};
+    [[nodiscard]] static constexpr bool split_early(size_t, size_t) noexcept { return false; }
+};
+
+// Directory, Bucket and split logic of Extendible Hashing, shared by EH_set and EH_map.
+// What a Bucket stores per element is defined by Slots, which has to provide
+//  - key_type, value_type, reference, const_reference and capacity (slots per Bucket)
+//  - trivially_copyable: whether the stored elements may be copied with memcpy
+//  - key(i), ref(i): access to a constructed slot
+//  - construct(i, key, args...): construct slot i, args are passed on to the mapped value
+//  - copy_construct(i, src, j): copy construct slot i from slot j of src
+//  - relocate(i, dst, j): move construct slot j of dst from slot i, then destroy slot i
+//  - destroy(i)
+//  - indexed: whether the Slots keep their own lookup structure, which then provide
+//    reset() to set it up for a new Bucket and find(key, n), returning the slot of key among the first
+//    n slots or capacity
+//  - ordered: whether the Slots keep their elements ascending by std::less of the keys, which then provide
+//    sift(i) to move a new element from slot i to its place among the slots before (returning that place),
+//    remove(i, n) to destroy slot i and close the gap among n slots and merge(n, src, m) to merge the m
+//    elements of src into the first n in one pass, skipping keys inside already (returning the new count).
+//    Elements keep their order where the core moves them otherwise (split, retain)
+// Slots must be trivially default constructible, so a new Bucket leaves them uninitialized.
+// With Digest set, the core keeps an order independent checksum of its keys (the sum of their mixed
+// hash values) and one per Bucket, so unequal sets are usually told apart in O(1) and differing hash
+// prefixes can be narrowed down without looking at keys. It costs a rehash per key where keys are
+// copied or dropped without hashing otherwise (merge, retain).
+// Buckets are reference counted, so snapshot() shares them with the new core. Every modification
+// first makes the Bucket it touches exclusive (own), cloning it if it is still shared. Values written
+// through iterators bypass this, so only cores without mutable values (EH_set) hand out snapshots.
+// SplitPolicy decides when a Bucket is split (see EH_split_on_overflow).
+template <typename Slots, bool Digest = false, typename SplitPolicy = EH_split_on_overflow> class EH_core;
+
+// checksum of a Bucket, empty unless Digest is set
+template <bool Digest> struct EH_bucket_checksum {
+    size_t checksum{0};
+};
+template <> struct EH_bucket_checksum<false> {};
+
+template <typename Slots, bool Digest, typename SplitPolicy> class EH_core {
+  public:
+    template <bool Const> class Iterator;
+    using key_type = typename Slots::key_type;
+    using value_type = typename Slots::value_type;
+    using size_type = size_t;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    using key_equal = std::equal_to<key_type>;
+    using hasher = std::hash<key_type>;
+
+    static constexpr size_type N{Slots::capacity};
+    static constexpr size_type full{N - SplitPolicy::spare};  // keys a Bucket takes without the spare slots
+    static_assert(SplitPolicy::spare < N, "no slots left besides the spare ones");
+
+  private:
+    // only the first arrsz slots are constructed
+    struct Bucket : EH_bucket_checksum<Digest> {
+        Slots slots;
+        size_type l{0};                   // local depth
+        size_type arrsz{0};               // number of elems in Bucket
+        std::atomic<size_type> refs{1};  // number of cores sharing this Bucket
+
+        Bucket() noexcept {  // user-provided, so new Bucket{} does not zero the slots
+            if constexpr (Slots::indexed) {
+                slots.reset();
+            }
+        }
+        Bucket(const Bucket& other) noexcept : Bucket{} { copy_from(other); }
+        Bucket& operator=(const Bucket&) = delete;
+        ~Bucket() noexcept { clear(); }
+
+        void copy_from(const Bucket& other) noexcept;
+        void clear() noexcept;
+        void remove_at(size_type i) noexcept;
+        [[nodiscard]] size_type find(const key_type& key) const noexcept;
+        [[nodiscard]] inline size_type high_bit() const noexcept;
+    };
+
+    static_assert(std::is_trivially_default_constructible_v<Slots>, "Slots must not initialize their storage");
+
+    static constexpr size_type prefetch_group{16};  // keys in flight per batch lookup step
+
+    size_type sz;        // actual size
+    size_type d;         // global depth
+    size_type nD;        // 2^d
+    size_type checksum;  // sum of mix(hash) over all keys, only kept with Digest
+    Bucket** buckets;
+    std::uint8_t* depths;  // local depth of the Bucket behind every directory slot, so walks over the
+                           // directory tell aliases apart without loading the Buckets
+
+    struct share_tag {};
+    EH_core(const EH_core& other, share_tag) noexcept;
+
+    // high_bit of the Bucket at directory slot i, read from the directory
+    [[nodiscard]] size_type high_bit(size_type i) const noexcept { return size_type{1} << depths[i]; }
+
+    // the bits least significant bits set, every bit if bits is the width of size_type or more
+    [[nodiscard]] static constexpr size_type low_mask(size_type bits) noexcept {
+        return bits < std::numeric_limits<size_type>::digits ? (size_type{1} << bits) - 1 : ~size_type{0};
+    }
+    [[nodiscard]] static constexpr size_type mix(size_type h) noexcept;
+    static void release(Bucket* b) noexcept;
+    Bucket* own(size_type i) noexcept;
+
+    void expansion() noexcept;
+    void split_bucket(size_type hash) noexcept;
+    template <typename Construct> iterator place(size_type h, Construct construct) noexcept;
+    template <typename Probe> void probe_batch(const key_type* keys, size_type n, Probe probe) const noexcept;
+    template <typename F> void for_each_bucket(size_type prefix, size_type bits, F f) const noexcept;
+    void merge_sorted(size_type i, const Bucket* ob) noexcept;
+    void retain_sorted(size_type i, const EH_core& other, bool common) noexcept;
+
+  public:
+    EH_core() noexcept;
+    EH_core(const EH_core& other) noexcept;
+    EH_core& operator=(const EH_core& other) = delete;
+    void assign(const EH_core& other) noexcept;
+
+    ~EH_core() noexcept;
+
+    [[nodiscard]] EH_core snapshot() const noexcept { return EH_core{*this, share_tag{}}; }
+
+    [[nodiscard]] size_type size() const noexcept { return sz; }
+    [[nodiscard]] size_type depth() const noexcept { return d; }
+    [[nodiscard]] size_type directory_size() const noexcept { return nD; }
+
+    template <typename K, typename... Args> std::pair<iterator, bool> add(bool check, K&& key, Args&&... args) noexcept;
+    void add_batch(const key_type* keys, size_type n) noexcept;
+    void reserve(size_type n) noexcept;
+
+    void merge(const EH_core& other) noexcept;
+    void retain(const EH_core& other, bool common) noexcept;
+    template <typename Eq> [[nodiscard]] bool equal(const EH_core& other, Eq eq) const noexcept;
+
+    template <typename F> void visit_buckets(F f) const noexcept;
+    template <typename Read> bool rebuild(size_type depth, Read read) noexcept;
+
+    [[nodiscard]] size_type digest(size_type prefix, size_type bits) const noexcept;
+    template <typename F> void for_each(size_type prefix, size_type bits, F f) const noexcept;
+
+    void clear() noexcept;
+    void clear_keys() noexcept;
+
+    size_type erase(const key_type& key) noexcept;
+    [[nodiscard]] size_type count(const key_type& key) const noexcept;
+    [[nodiscard]] iterator find(const key_type& key) noexcept;
+    [[nodiscard]] const_iterator find(const key_type& key) const noexcept;
+    void count_batch(const key_type* keys, size_type n, bool* out) const noexcept;
+    void find_batch(const key_type* keys, size_type n, const_iterator* out) const noexcept;
+
+    void swap(EH_core& other) noexcept;
+
+    [[nodiscard]] iterator begin() noexcept { return iterator(0, 0, this); }
+    [[nodiscard]] iterator end() noexcept { return iterator(this); }
+    [[nodiscard]] const_iterator begin() const noexcept { return const_iterator(0, 0, this); }
+    [[nodiscard]] const_iterator end() const noexcept { return const_iterator(this); }
+
+    template <typename PrintSlot> void dump(std::ostream& o, PrintSlot print_slot) const noexcept;
+};
+
+/*--------------------------Bucket methods----------------------------*/
+
+// copies local depth, checksum and elements of other into this empty Bucket
+// trivially copyable elements are copied with one memcpy, otherwise only the used slots are copy constructed
+// O(other.arrsz)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::Bucket::copy_from(const Bucket& other) noexcept {
+    static_cast<EH_bucket_checksum<Digest>&>(*this) = other;
+    l = other.l;
+    arrsz = other.arrsz;
+    if constexpr (Slots::trivially_copyable) {
+        std::memcpy(static_cast<void*>(&slots), &other.slots, sizeof(Slots));
+    } else {
+        for (size_type i{0}; i < arrsz; ++i) {
+            slots.copy_construct(i, other.slots, i);
+        }
+    }
+}
+
+// destroys the used slots
+// O(arrsz)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::Bucket::clear() noexcept {
+    for (size_type i{0}; i < arrsz; ++i) {
+        slots.destroy(i);
+    }
+    arrsz = 0;
+    if constexpr (Digest) {
+        this->checksum = 0;
+    }
+}
+
+// find Element in Bucket, through the index of the Slots if they keep one
+// returns index of Element in Bucket, if found, and N otherwise
+// O(N) = O(1)
+template <typename Slots, bool Digest, typename SplitPolicy>
+typename EH_core<Slots, Digest, SplitPolicy>::size_type
+EH_core<Slots, Digest, SplitPolicy>::Bucket::find(const key_type& key) const noexcept {
+    if constexpr (Slots::indexed) {
+        return slots.find(key, arrsz);
+    }
+    for (size_type i{0}; i < arrsz; ++i) {
+        if (key_equal{}(key, slots.key(i))) {
+            return i;
+        }
+    }
+    return N;
+}
+
+// destroy Element i, move the last element into its slot and decrease size
+// ordered Slots shift the elements behind i instead
+// O(1)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::Bucket::remove_at(size_type i) noexcept {
+    if constexpr (Slots::ordered) {
+        slots.remove(i, arrsz--);
+        return;
+    }
+    slots.destroy(i);
+    if (i != --arrsz) {
+        slots.relocate(arrsz, slots, i);
+    }
+}
+
+// returns highest bit that bucket elems agree on
+template <typename Slots, bool Digest, typename SplitPolicy>
+inline typename EH_core<Slots, Digest, SplitPolicy>::size_type
+EH_core<Slots, Digest, SplitPolicy>::Bucket::high_bit() const noexcept {
+    return size_type{1} << l;
+}
+
+/*------------------------private methods---------------------*/
+
+// drops one reference to b, the last core sharing it deletes it
+// O(b->arrsz)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::release(Bucket* b) noexcept {
+    if (b->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete b;
+    }
+}
+
+// returns the Bucket at directory slot i, ready to be modified. If a snapshot still shares it,
+// it is cloned and every pointer of this core is redirected to the clone
+// O(1) if not shared, O(N + nD / 2^l) otherwise
+template <typename Slots, bool Digest, typename SplitPolicy>
+typename EH_core<Slots, Digest, SplitPolicy>::Bucket* EH_core<Slots, Digest, SplitPolicy>::own(size_type i) noexcept {
+    Bucket* b = buckets[i];
+    if (b->refs.load(std::memory_order_acquire) == 1) {
+        return b;
+    }
+    Bucket* clone{new Bucket{*b}};
+    for (size_type j{i & (high_bit(i) - 1)}; j < nD; j += high_bit(i)) {
+        buckets[j] = clone;
+    }
+    release(b);
+    return clone;
+}
+
+// spreads every bit of h over the whole word (splitmix64 finalizer), so sums of hashes that are
+// close to each other (std::hash of integers is the identity) still differ
+// O(1)
+template <typename Slots, bool Digest, typename SplitPolicy>
+constexpr typename EH_core<Slots, Digest, SplitPolicy>::size_type
+EH_core<Slots, Digest, SplitPolicy>::mix(size_type h) noexcept {
+    uint64_t z{h};
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return static_cast<size_type>(z ^ (z >> 31));
+}
+
+// doubles the pointer array and the depths
+// O(nD)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::expansion() noexcept {
+    size_type new_nD = size_type{1} << ++d;
+    Bucket** new_buckets{new Bucket*[new_nD]};
+    std::uint8_t* new_depths{new std::uint8_t[new_nD]};
+    for (size_type i{0}; i < nD; ++i) {
+        new_buckets[i] = buckets[i];
+        new_buckets[i + nD] = buckets[i];  // pointer repeat with offset nD
+    }
+    std::memcpy(new_depths, depths, nD);
+    std::memcpy(new_depths + nD, depths, nD);
+    delete[] buckets;
+    delete[] depths;
+    buckets = new_buckets;
+    depths = new_depths;
+    nD = new_nD;
+}
+
+// Split Bucket buckets[hash] and reassign pointers
+// O(N) = O(1)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::split_bucket(size_type hash) noexcept {
+    Bucket* b = own(hash);
+    if (b->l >= d) {  // ensure there is enough space to split
+        expansion();
+    }
+    Bucket* b1{new Bucket{}};  // 1 prefix
+    b1->l = ++b->l;            // l increases by 1
+
+    // rehash every Element from original Bucket and move it to its new place
+    // only the l+1 least significant bit must be checked, so rbitshift by l and
+    // test if bit is set. Elements that stay are compacted to the front, no temp
+    // copy needed, since kept is never past the slot that is currently checked
+    size_type kept{0};
+    for (size_type i{0}; i < b->arrsz; ++i) {
+        size_type h{hasher{}(b->slots.key(i))};
+        if (h >> (b->l - 1) & 1) {
+            if constexpr (Digest) {
+                b->checksum -= mix(h);
+                b1->checksum += mix(h);
+            }
+            b->slots.relocate(i, b1->slots, b1->arrsz++);
+        } else if (kept++ != i) {
+            b->slots.relocate(i, b->slots, kept - 1);
+        }
+    }
+    b->arrsz = kept;
+
+    // get first index that should point to new Bucket (first pointer points to
+    // Original, so first pointer + offset points to new)
+    size_type offset{size_type{1} << (b->l - 1)};
+    size_type first{(hash & (offset - 1)) + offset};  // first Pointer from original Bucket is hash value % offset
+    offset += offset;                                 // double old offset (offset for new buckets)
+
+    // assign every pointer that should point to new Bucket (2 * original
+    // offset), every slot of both halves gets the new depth
+    for (; first < nD; first += offset) {
+        buckets[first] = b1;
+        depths[first] = static_cast<std::uint8_t>(b->l);
+        depths[first - offset / 2] = static_cast<std::uint8_t>(b->l);
+    }
+}
+
+// places a new element with full hash value h, splitting until its Bucket has room. Before that, the
+// Bucket is split once if SplitPolicy asks for an early split. Once full, a Bucket takes a spare slot
+// instead of a split that would double the directory
+// construct(slots, i) constructs the element in slot i
+// O(1)
+template <typename Slots, bool Digest, typename SplitPolicy>
+template <typename Construct>
+typename EH_core<Slots, Digest, SplitPolicy>::iterator
+EH_core<Slots, Digest, SplitPolicy>::place(size_type h, Construct construct) noexcept {
+    size_type hash = h & (nD - 1);
+    if (buckets[hash]->arrsz < full && SplitPolicy::split_early(buckets[hash]->arrsz, full)) {
+        split_bucket(hash);
+        hash = h & (nD - 1);
+    }
+    // bucket overflow, split (and expansion) necessary
+    while (buckets[hash]->arrsz >= full && !(buckets[hash]->arrsz < N && depths[hash] >= d)) {
+        split_bucket(hash);
+        hash = h & (nD - 1);
+    }
+    Bucket* b = own(hash);
+    construct(b->slots, b->arrsz);
+    size_type i{b->arrsz++};
+    if constexpr (Slots::ordered) {
+        i = b->slots.sift(i);
+    }
+    ++sz;
+    if constexpr (Digest) {
+        checksum += mix(h);
+        b->checksum += mix(h);
+    }
+    return iterator(i, hash, this);
+}
+
+// Probes keys in groups of prefetch_group: first hash every key of the group and
+// prefetch its directory slot, then load the Bucket pointers and prefetch the Buckets,
+// then search them. The dependent loads of one group overlap instead of stalling
+// one after another. probe is called with (position in keys, hash, index in Bucket)
+// O(n)
+template <typename Slots, bool Digest, typename SplitPolicy>
+template <typename Probe>
+void EH_core<Slots, Digest, SplitPolicy>::probe_batch(const key_type* keys, size_type n, Probe probe) const noexcept {
+    size_type hashes[prefetch_group];
+    const Bucket* group[prefetch_group];
+
+    for (size_type base{0}; base < n; base += prefetch_group) {
+        size_type len{std::min(prefetch_group, n - base)};
+        for (size_type i{0}; i < len; ++i) {
+            hashes[i] = hasher{}(keys[base + i]) & (nD - 1);
+            PREFETCH(&buckets[hashes[i]]);
+        }
+        for (size_type i{0}; i < len; ++i) {
+            group[i] = buckets[hashes[i]];
+            PREFETCH(&group[i]->slots);
+            PREFETCH(&group[i]->arrsz);  // arrsz sits behind the slots, possibly on another cache line
+        }
+        for (size_type i{0}; i < len; ++i) {
+            probe(base + i, hashes[i], group[i]->find(keys[base + i]));
+        }
+    }
+}
+
+// calls f(b, partial) for every Bucket holding keys whose hash ends in the bits least significant bits
+// of prefix. partial is set if the Bucket is shallower than bits and holds other keys as well, if it is
+// deeper the region is spread over every unique Bucket behind the slots prefix + k * 2^bits
+// O(nD / 2^bits)
+template <typename Slots, bool Digest, typename SplitPolicy>
+template <typename F>
+void EH_core<Slots, Digest, SplitPolicy>::for_each_bucket(size_type prefix, size_type bits, F f) const noexcept {
+    const Bucket* b = buckets[prefix & (nD - 1)];
+    if (b->l <= bits) {
+        f(b, b->l < bits);
+        return;
+    }
+    // bits < l <= d here, so the step can't overflow
+    for (size_type i{prefix}; i < nD; i += size_type{1} << bits) {
+        if (high_bit(i) > i) {
+            f(buckets[i], false);
+        }
+    }
+}
+
+// merges the keys of ob into the Bucket at directory slot i, for ordered Slots, the result has to fit
+// the Bucket. With Digest, the checksum of the Bucket is recomputed from its keys afterwards
+// O(N)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::merge_sorted(size_type i, const Bucket* ob) noexcept {
+    Bucket* b = own(i);
+    size_type before{b->arrsz};
+    b->arrsz = b->slots.merge(b->arrsz, ob->slots, ob->arrsz);
+    sz += b->arrsz - before;
+    if constexpr (Digest) {
+        checksum -= b->checksum;
+        b->checksum = 0;
+        for (size_type j{0}; j < b->arrsz; ++j) {
+            b->checksum += mix(hasher{}(b->slots.key(j)));
+        }
+        checksum += b->checksum;
+    }
+}
+
+// retain for the Bucket at directory slot i (its first slot) with ordered Slots: the kept keys are compacted
+// in one pass instead of shifting the tail behind every dropped one, and if the Bucket of other holds all
+// candidates, both sorted runs are walked side by side instead of searching every key
+// O(N + other N)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::retain_sorted(size_type i, const EH_core& other, bool common) noexcept {
+    Bucket* b = buckets[i];
+    const Bucket* ob = other.buckets[i & (other.nD - 1)];
+    const bool covered{other.depths[i & (other.nD - 1)] <= depths[i]};
+    size_type kept{0};
+    size_type k{0};  // position in ob, if covered
+    for (size_type j{0}; j < b->arrsz; ++j) {
+        const key_type& key{b->slots.key(j)};
+        bool found{false};
+        if (covered) {
+            while (k < ob->arrsz && std::less<key_type>{}(ob->slots.key(k), key)) {
+                ++k;
+            }
+            found = k < ob->arrsz && key_equal{}(ob->slots.key(k), key);
+        } else {
+            found = other.buckets[hasher{}(key) & (other.nD - 1)]->find(key) != N;
+        }
+        if (found == common) {
+            if (kept != j) {
+                b->slots.relocate(j, b->slots, kept);
+            }
+            ++kept;
+            continue;
+        }
+        b = own(i);  // the clone keeps the keys in the same slots
+        if constexpr (Digest) {
+            size_type m{mix(hasher{}(b->slots.key(j)))};
+            checksum -= m;
+            b->checksum -= m;
+        }
+        b->slots.destroy(j);
+        --sz;
+    }
+    if (kept != b->arrsz) {
+        b->arrsz = kept;
+    }
+}
+
+/*---------------------------EH_core methods-----------------------------*/
+
+// create empty core (contains 1 Bucket)
+// O(1)
+template <typename Slots, bool Digest, typename SplitPolicy>
+EH_core<Slots, Digest, SplitPolicy>::EH_core() noexcept
+    : sz{0}, d{0}, nD{1}, checksum{0}, buckets{new Bucket*[nD]}, depths{new std::uint8_t[nD]{}} {
+    buckets[0] = new Bucket{};
+}
+
+// copies all elements from other, only the first slot of every Bucket is dereferenced
+// O(other.nD)
+template <typename Slots, bool Digest, typename SplitPolicy>
+EH_core<Slots, Digest, SplitPolicy>::EH_core(const EH_core& other) noexcept
+    : sz{other.sz}, d{other.d}, nD{other.nD}, checksum{other.checksum}, buckets{new Bucket*[nD]},
+      depths{new std::uint8_t[nD]} {
+    std::memcpy(depths, other.depths, nD);
+    for (size_type i{0}; i < nD; ++i) {
+        if (high_bit(i) > i) {
+            buckets[i] = new Bucket{*other.buckets[i]};
+        } else {
+            buckets[i] = buckets[i & (high_bit(i) - 1)];
+        }
+    }
+}
+
+// shares every Bucket of other, only the directory is copied
+// O(other.nD)
+template <typename Slots, bool Digest, typename SplitPolicy>
+EH_core<Slots, Digest, SplitPolicy>::EH_core(const EH_core& other, share_tag) noexcept
+    : sz{other.sz}, d{other.d}, nD{other.nD}, checksum{other.checksum}, buckets{new Bucket*[nD]},
+      depths{new std::uint8_t[nD]} {
+    std::memcpy(depths, other.depths, nD);
+    for (size_type i{0}; i < nD; ++i) {
+        buckets[i] = other.buckets[i];
+        if (high_bit(i) > i) {
+            buckets[i]->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+// Destruktor
+// find out from the depths if pointer is last pointer to bucket and release it
+// O(nD)
+template <typename Slots, bool Digest, typename SplitPolicy> EH_core<Slots, Digest, SplitPolicy>::~EH_core() noexcept {
+    for (size_type i{0}; i < nD; ++i) {
+        if (i >= nD - high_bit(i)) {
+            release(buckets[i]);
+        }
+    }
+    delete[] buckets;
+    delete[] depths;
+}
+
+// makes this a copy of other with the same directory shape, no key is rehashed
+// Buckets of this that are not shared with a snapshot are emptied and reused, only
+// missing ones are allocated and left over ones deleted
+// O(nD + other.nD + other.sz)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::assign(const EH_core& other) noexcept {
+    if (this == &other) {
+        return;
+    }
+    // the old directory doubles as stack of reusable Buckets, spare never passes i
+    size_type spare{0};
+    for (size_type i{0}; i < nD; ++i) {
+        if (high_bit(i) <= i) {
+            continue;  // not the first pointer to this Bucket
+        }
+        Bucket* b = buckets[i];
+        if (b->refs.load(std::memory_order_acquire) == 1) {
+            b->clear();
+            buckets[spare++] = b;
+        } else {
+            release(b);
+        }
+    }
+
+    Bucket** dir{new Bucket*[other.nD]};
+    for (size_type i{0}; i < other.nD; ++i) {
+        if (other.high_bit(i) > i) {
+            Bucket* b = spare ? buckets[--spare] : new Bucket{};
+            b->copy_from(*other.buckets[i]);
+            dir[i] = b;
+        } else {
+            dir[i] = dir[i & (other.high_bit(i) - 1)];
+        }
+    }
+    while (spare) {
+        delete buckets[--spare];
+    }
+    delete[] buckets;
+    if (nD != other.nD) {
+        delete[] depths;
+        depths = new std::uint8_t[other.nD];
+    }
+    std::memcpy(depths, other.depths, other.nD);
+
+    buckets = dir;
+    sz = other.sz;
+    d = other.d;
+    nD = other.nD;
+    checksum = other.checksum;
+}
+
+// Inserts key if it is not inside yet (only checked if check is set)
+// May call expansion and split multiple times
+// key and args are only consumed if the element is inserted
+// O(1)
+template <typename Slots, bool Digest, typename SplitPolicy>
+template <typename K, typename... Args>
+std::pair<typename EH_core<Slots, Digest, SplitPolicy>::iterator, bool>
+EH_core<Slots, Digest, SplitPolicy>::add(bool check, K&& key, Args&&... args) noexcept {
+    size_type h{hasher{}(key)};
+    size_type hash = h & (nD - 1);
+    size_type idx{0};
+    if (check && (idx = buckets[hash]->find(key)) != N) {
+        return {iterator(idx, hash, this), false};  // if already inside, skip
+    }
+
+    return {place(h,
+                  [&](Slots& slots, size_type i) {
+                      slots.construct(i, std::forward<K>(key), std::forward<Args>(args)...);
+                  }),
+            true};
+}
+
+// inserts every key that is not inside yet, elements of EH_map get a value initialized value
+// like probe_batch, keys are hashed and their directory slots and Buckets prefetched a group at a time,
+// the Buckets are looked up again on insertion, since splits of earlier keys may have changed them
+// O(n)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::add_batch(const key_type* keys, size_type n) noexcept {
+    size_type hashes[prefetch_group];
+
+    for (size_type base{0}; base < n; base += prefetch_group) {
+        size_type len{std::min(prefetch_group, n - base)};
+        for (size_type i{0}; i < len; ++i) {
+            hashes[i] = hasher{}(keys[base + i]);
+            PREFETCH(&buckets[hashes[i] & (nD - 1)]);
+        }
+        for (size_type i{0}; i < len; ++i) {
+            const Bucket* b = buckets[hashes[i] & (nD - 1)];
+            PREFETCH(&b->slots);
+            PREFETCH(&b->arrsz);
+        }
+        for (size_type i{0}; i < len; ++i) {
+            const key_type& key{keys[base + i]};
+            if (buckets[hashes[i] & (nD - 1)]->find(key) == N) {
+                place(hashes[i], [&key](Slots& slots, size_type j) { slots.construct(j, key); });
+            }
+        }
+    }
+}
+
+// splits every Bucket until there are enough of them for n elements at about 70% fill
+// (the average fill of Extendible Hashing with evenly spread hashes), so inserting them splits rarely
+// O(nD) for the resulting directory
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::reserve(size_type n) noexcept {
+    size_type depth{0};
+    while ((size_type{1} << depth) * full * 7 < n * 10) {
+        ++depth;
+    }
+    for (size_type i{0}; i < nD; ++i) {  // nD grows while splitting, the new slots are visited as well
+        while (depths[i] < depth) {
+            split_bucket(i);
+        }
+    }
+}
+
+// copies every element of other that is not inside yet
+// walks the unique Buckets of other, as long as this Bucket for the same hash prefix is not
+// deeper it holds all candidates, so keys are only rehashed if it is deeper or has to be split
+// O(other.nD + other.sz)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::merge(const EH_core& other) noexcept {
+    for (size_type i{0}; i < other.nD; ++i) {
+        if (other.high_bit(i) <= i) {
+            continue;  // not the first pointer to this Bucket
+        }
+        const Bucket* ob = other.buckets[i];
+        if constexpr (Slots::ordered) {
+            // all keys of ob fit the Bucket they belong to: merge the two sorted runs at once
+            const Bucket* b = buckets[i & (nD - 1)];
+            if (ob->arrsz && depths[i & (nD - 1)] <= other.depths[i] && b->arrsz + ob->arrsz <= full &&
+                !SplitPolicy::split_early(b->arrsz + ob->arrsz - 1, full)) {
+                merge_sorted(i & (nD - 1), ob);
+                continue;
+            }
+        }
+        for (size_type j{0}; j < ob->arrsz; ++j) {
+            Bucket* b = buckets[i & (nD - 1)];  // reloaded, a previous key might have split it
+            if (depths[i & (nD - 1)] <= other.depths[i] && b->arrsz < full &&
+                !SplitPolicy::split_early(b->arrsz, full)) {
+                if (b->find(ob->slots.key(j)) == N) {
+                    b = own(i & (nD - 1));
+                    b->slots.copy_construct(b->arrsz, ob->slots, j);
+                    if constexpr (Slots::ordered) {
+                        b->slots.sift(b->arrsz);
+                    }
+                    ++b->arrsz;
+                    ++sz;
+                    if constexpr (Digest) {
+                        size_type m{mix(hasher{}(ob->slots.key(j)))};
+                        checksum += m;
+                        b->checksum += m;
+                    }
+                }
+                continue;
+            }
+            size_type h{hasher{}(ob->slots.key(j))};
+            if (buckets[h & (nD - 1)]->find(ob->slots.key(j)) == N) {
+                place(h, [ob, j](Slots& slots, size_type k) { slots.copy_construct(k, ob->slots, j); });
+            }
+        }
+    }
+}
+
+// keeps only the elements whose key other contains (common = true) or does not contain (common = false)
+// walks the unique Buckets of this, as long as the Bucket of other for the same hash prefix is not
+// deeper it holds all candidates, so keys are only rehashed if it is deeper
+// O(nD + sz)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::retain(const EH_core& other, bool common) noexcept {
+    for (size_type i{0}; i < nD; ++i) {
+        if (high_bit(i) <= i) {
+            continue;  // not the first pointer to this Bucket
+        }
+        if constexpr (Slots::ordered) {
+            retain_sorted(i, other, common);
+            continue;
+        }
+        Bucket* b = buckets[i];
+        const Bucket* ob = other.buckets[i & (other.nD - 1)];
+        const bool covered{other.depths[i & (other.nD - 1)] <= depths[i]};
+        for (size_type j{0}; j < b->arrsz;) {
+            const key_type& key{b->slots.key(j)};
+            const Bucket* candidate = covered ? ob : other.buckets[hasher{}(key) & (other.nD - 1)];
+            if ((candidate->find(key) != N) == common) {
+                ++j;
+            } else {
+                b = own(i);  // key stays valid, a shared Bucket is kept alive by the snapshot
+                if constexpr (Digest) {
+                    size_type m{mix(hasher{}(key))};
+                    checksum -= m;
+                    b->checksum -= m;
+                }
+                b->remove_at(j);  // moves the last element (or the ones behind) to j
+                --sz;
+            }
+        }
+    }
+}
+
+// compares the elements of this and other, eq(slots, i, other_slots, j) compares two elements with equal keys
+// rejects on different sizes or checksums first, then walks the unique Buckets of this. If the Bucket of
+// other for the same hash prefix has the same local depth, it holds exactly the same keys, so their
+// sizes have to match. If it is not deeper it holds all candidates, only otherwise keys are rehashed
+// O(nD + sz)
+template <typename Slots, bool Digest, typename SplitPolicy>
+template <typename Eq>
+bool EH_core<Slots, Digest, SplitPolicy>::equal(const EH_core& other, Eq eq) const noexcept {
+    if (sz != other.sz) {
+        return false;
+    }
+    if constexpr (Digest) {
+        if (checksum != other.checksum) {
+            return false;
+        }
+    }
+    for (size_type i{0}; i < nD; ++i) {
+        if (high_bit(i) <= i) {
+            continue;  // not the first pointer to this Bucket
+        }
+        const Bucket* b = buckets[i];
+        const Bucket* ob = other.buckets[i & (other.nD - 1)];
+        if (ob->l == b->l && ob->arrsz != b->arrsz) {
+            return false;
+        }
+        const bool covered{other.depths[i & (other.nD - 1)] <= depths[i]};
+        for (size_type j{0}; j < b->arrsz; ++j) {
+            const key_type& key{b->slots.key(j)};
+            const Bucket* candidate = covered ? ob : other.buckets[hasher{}(key) & (other.nD - 1)];
+            size_type k{candidate->find(key)};
+            if (k == N || !eq(b->slots, j, candidate->slots, k)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// swap with empty core
+// O(nD) (because Destruktor)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::clear() noexcept {
+    EH_core temp{};
+    swap(temp);
+}
+
+// calls f(l, arrsz, slots) for every unique Bucket, in the order of their first directory slot
+// O(nD)
+template <typename Slots, bool Digest, typename SplitPolicy>
+template <typename F>
+void EH_core<Slots, Digest, SplitPolicy>::visit_buckets(F f) const noexcept {
+    for (size_type i{0}; i < nD; ++i) {
+        if (high_bit(i) > i) {
+            const Bucket* b = buckets[i];
+            f(b->l, b->arrsz, b->slots);
+        }
+    }
+}
+
+// replaces the content by a directory of 2^depth slots and Buckets in the order of visit_buckets:
+// read(l, arrsz, slots) fills the Bucket for the next slot that is not assigned yet. It constructs the
+// elements in slots and returns false on failure, with arrsz counting only the constructed elements.
+// All Buckets are read before the directory is allocated, and only if together they cover exactly 2^depth
+// slots and the deepest one has local depth depth (the directory only doubles for such a Bucket), so a corrupt
+// depth fails on the Buckets instead of allocating a huge directory.
+// Every key is hashed once to check that it belongs to the slots of its Bucket (a file of a build with another
+// hasher, or a corrupt one, would otherwise load keys that lookups never find), and checked to be unique in its
+// Bucket (ordered Slots have to be strictly ascending). Keys are not reinserted.
+// Returns false and leaves this unchanged if read fails or the Buckets don't form a valid directory
+// O(2^depth + elements), O(2^depth + elements * N) for Slots without index or order
+template <typename Slots, bool Digest, typename SplitPolicy>
+template <typename Read>
+bool EH_core<Slots, Digest, SplitPolicy>::rebuild(size_type depth, Read read) noexcept {
+    if (depth >= std::numeric_limits<size_type>::digits) {
+        return false;
+    }
+    const size_type new_nD{size_type{1} << depth};
+    std::vector<Bucket*> read_buckets{};
+    size_type covered{0};  // directory slots of the Buckets read so far
+    size_type deepest{0};
+    size_type new_sz{0};
+    size_type new_checksum{0};
+
+    bool ok{true};
+    while (ok && covered < new_nD) {
+        Bucket* b{new Bucket{}};
+        ok = read(b->l, b->arrsz, b->slots) && b->l <= depth && (new_nD >> b->l) <= new_nD - covered;
+        if (!ok) {
+            delete b;
+            break;
+        }
+        read_buckets.push_back(b);
+        covered += new_nD >> b->l;
+        deepest = std::max(deepest, b->l);
+        new_sz += b->arrsz;
+    }
+
+    ok = ok && deepest == depth;
+    Bucket** dir{ok ? new (std::nothrow) Bucket*[new_nD]() : nullptr};
+    std::uint8_t* new_depths{dir ? new (std::nothrow) std::uint8_t[new_nD] : nullptr};
+    ok = ok && new_depths;
+    size_type i{0};  // next slot that is not assigned yet
+    for (size_type k{0}; ok && k < read_buckets.size(); ++k) {
+        Bucket* b = read_buckets[k];
+        while (dir[i]) {
+            ++i;  // covered by an earlier Bucket
+        }
+        ok = i < b->high_bit();
+        for (size_type j{i}; ok && j < new_nD; j += b->high_bit()) {
+            ok = !dir[j];
+        }
+        for (size_type j{0}; ok && j < b->arrsz; ++j) {
+            const key_type& key{b->slots.key(j)};
+            size_type h{hasher{}(key)};
+            if constexpr (Slots::ordered) {
+                ok = j == 0 || std::less<key_type>{}(b->slots.key(j - 1), key);
+            } else {
+                ok = b->find(key) == j;
+            }
+            ok = ok && (h & (b->high_bit() - 1)) == i;
+            if constexpr (Digest) {
+                b->checksum += mix(h);
+                new_checksum += mix(h);
+            }
+        }
+        for (size_type j{i}; ok && j < new_nD; j += b->high_bit()) {
+            dir[j] = b;
+            new_depths[j] = static_cast<std::uint8_t>(b->l);
+        }
+    }
+
+    if (!ok) {
+        for (Bucket* b : read_buckets) {
+            delete b;
+        }
+        delete[] dir;
+        delete[] new_depths;
+        return false;
+    }
+    for (size_type j{0}; j < nD; ++j) {
+        if (high_bit(j) > j) {
+            release(buckets[j]);
+        }
+    }
+    delete[] buckets;
+    delete[] depths;
+    buckets = dir;
+    depths = new_depths;
+    d = depth;
+    nD = new_nD;
+    sz = new_sz;
+    checksum = new_checksum;
+    return true;
+}
+
+// checksum of the keys whose hash ends in the bits least significant bits of prefix (needs Digest)
+// bits = 0 is the checksum of the whole set. Regions are independent of the directory shape, so two
+// copies of a set can compare them level by level and descend only into the halves that differ
+// O(1) if bits is 0 or the local depth of the region's Bucket, O(N) if larger, O(nD / 2^bits) if smaller
+template <typename Slots, bool Digest, typename SplitPolicy>
+typename EH_core<Slots, Digest, SplitPolicy>::size_type
+EH_core<Slots, Digest, SplitPolicy>::digest(size_type prefix, size_type bits) const noexcept {
+    static_assert(Digest, "digest needs the Digest flag");
+    if (bits == 0) {
+        return checksum;
+    }
+    const size_type mask{low_mask(bits)};
+    prefix &= mask;
+    size_type sum{0};
+    for_each_bucket(prefix, bits, [&](const Bucket* b, bool partial) {
+        if (!partial) {
+            sum += b->checksum;
+            return;
+        }
+        for (size_type j{0}; j < b->arrsz; ++j) {
+            size_type h{hasher{}(b->slots.key(j))};
+            if ((h & mask) == prefix) {
+                sum += mix(h);
+            }
+        }
+    });
+    return sum;
+}
+
+// calls f(slots, i) for every element whose key hash ends in the bits least significant bits of prefix
+// O(N + nD / 2^bits + elements in the region)
+template <typename Slots, bool Digest, typename SplitPolicy>
+template <typename F>
+void EH_core<Slots, Digest, SplitPolicy>::for_each(size_type prefix, size_type bits, F f) const noexcept {
+    const size_type mask{low_mask(bits)};
+    prefix &= mask;
+    for_each_bucket(prefix, bits, [&](const Bucket* b, bool partial) {
+        for (size_type j{0}; j < b->arrsz; ++j) {
+            if (!partial || (hasher{}(b->slots.key(j)) & mask) == prefix) {
+                f(b->slots, j);
+            }
+        }
+    });
+}
+
+// clears all values, without losing structure
+// a Bucket shared with a snapshot is replaced by an empty one instead
+// O(nD)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::clear_keys() noexcept {
+    for (size_type i{0}; i < nD; ++i) {
+        if (high_bit(i) <= i) {
+            continue;  // not the first pointer to this Bucket
+        }
+        Bucket* b = buckets[i];
+        if (b->refs.load(std::memory_order_acquire) == 1) {
+            b->clear();
+            continue;
+        }
+        Bucket* empty{new Bucket{}};
+        empty->l = b->l;
+        for (size_type j{i}; j < nD; j += b->high_bit()) {
+            buckets[j] = empty;
+        }
+        release(b);
+    }
+    sz = 0;
+    checksum = 0;
+}
+
+// hash, find the key and remove it from its Bucket (made exclusive first)
+// O(1)
+template <typename Slots, bool Digest, typename SplitPolicy>
+typename EH_core<Slots, Digest, SplitPolicy>::size_type
+EH_core<Slots, Digest, SplitPolicy>::erase(const key_type& key) noexcept {
+    size_type h{hasher{}(key)};
+    size_type idx{buckets[h & (nD - 1)]->find(key)};
+    if (idx == N) {
+        return 0;
+    }
+    Bucket* b = own(h & (nD - 1));
+    b->remove_at(idx);
+    --sz;
+    if constexpr (Digest) {
+        checksum -= mix(h);
+        b->checksum -= mix(h);
+    }
+    return 1;
+}
+
+// hash and call Bucket find
+// O(1)
+template <typename Slots, bool Digest, typename SplitPolicy>
+typename EH_core<Slots, Digest, SplitPolicy>::size_type
+EH_core<Slots, Digest, SplitPolicy>::count(const key_type& key) const noexcept {
+    return buckets[hasher{}(key) & (nD - 1)]->find(key) != N;
+}
+
+// hash and call Bucket find
+// O(1)
+template <typename Slots, bool Digest, typename SplitPolicy>
+typename EH_core<Slots, Digest, SplitPolicy>::iterator
+EH_core<Slots, Digest, SplitPolicy>::find(const key_type& key) noexcept {
+    size_type hash{hasher{}(key) & (nD - 1)};
+    size_type idx = buckets[hash]->find(key);
+    return idx != N ? iterator(idx, hash, this) : end();
+}
+
+// hash and call Bucket find
+// O(1)
+template <typename Slots, bool Digest, typename SplitPolicy>
+typename EH_core<Slots, Digest, SplitPolicy>::const_iterator
+EH_core<Slots, Digest, SplitPolicy>::find(const key_type& key) const noexcept {
+    size_type hash{hasher{}(key) & (nD - 1)};
+    size_type idx = buckets[hash]->find(key);
+    return idx != N ? const_iterator(idx, hash, this) : end();
+}
+
+// batched count: out[i] is set if keys[i] is inside
+// O(n)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::count_batch(const key_type* keys, size_type n, bool* out) const noexcept {
+    probe_batch(keys, n, [out](size_type i, size_type, size_type idx) { out[i] = idx != N; });
+}
+
+// batched find: out[i] is the iterator to keys[i], or end() if not found
+// O(n)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void
+EH_core<Slots, Digest, SplitPolicy>::find_batch(const key_type* keys, size_type n, const_iterator* out) const noexcept {
+    probe_batch(keys, n, [this, out](size_type i, size_type hash, size_type idx) {
+        out[i] = idx != N ? const_iterator(idx, hash, this) : end();
+    });
+}
+
+// just uses std::swap for every instance variable
+// O(1)
+template <typename Slots, bool Digest, typename SplitPolicy>
+void EH_core<Slots, Digest, SplitPolicy>::swap(EH_core& other) noexcept {
+    using std::swap;
+    swap(d, other.d);
+    swap(nD, other.nD);
+    swap(sz, other.sz);
+    swap(checksum, other.checksum);
+    swap(buckets, other.buckets);
+    swap(depths, other.depths);
+}
+
+// Outputs every directory entry and its Bucket to ostream
+// print_slot(o, slots, i) prints one element
+template <typename Slots, bool Digest, typename SplitPolicy>
+template <typename PrintSlot>
+void EH_core<Slots, Digest, SplitPolicy>::dump(std::ostream& o, PrintSlot print_slot) const noexcept {
+    for (size_type i{0}; i < nD; ++i) {
+        Bucket* b = buckets[i];
+        size_type orig_bucket = i & (b->high_bit() - 1);
+        o << i;
+        if (orig_bucket != i) {
+            o << " ~~> " << orig_bucket;  // if pointer isnt first to a bucket show reference to first Bucket
+        }
+        o << " --> [l = ";
+        o << b->l << ", offset = " << b->high_bit() << ", arrsz = " << b->arrsz << " | ";
+        for (size_type j{0}; j < b->arrsz; ++j) {
+            print_slot(o, b->slots, j);
+            o << ' ';
+        }
+        o << "]\n";
+    }
+}
+
+/*---------------------------Iterator Class-------------------------------*/
+
+// operator-> for iterators whose reference is a proxy object (EH_map)
+template <typename Ref> struct EH_arrow_proxy {
+    Ref ref;
+    const Ref* operator->() const noexcept { return &ref; }
+};
+
+template <typename Slots, bool Digest, typename SplitPolicy>
+template <bool Const> class EH_core<Slots, Digest, SplitPolicy>::Iterator {
+  public:
+    using value_type = typename Slots::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<Const, typename Slots::const_reference, typename Slots::reference>;
+    using pointer = std::conditional_t<std::is_reference_v<reference>, std::add_pointer_t<reference>,
+                                       EH_arrow_proxy<reference>>;
+    using iterator_category = std::forward_iterator_tag;
+
+  private:
+    using core_pointer = std::conditional_t<Const, const EH_core*, EH_core*>;
+    using bucket_pointer = std::conditional_t<Const, const Bucket*, Bucket*>;
+    friend class Iterator<!Const>;
+
+    size_type idx{0};
+    core_pointer set{nullptr};
+    size_type b{0};
+
+    // skip to the next, first ptr, that is the first occurence, to point to a
+    // non-empty Bucket
+    void skip() noexcept {
+        while (b >= set->high_bit(b) || set->buckets[b]->arrsz == 0) {  // aliases are skipped by their depth
+            b++;
+            if (is_end()) {  // if we are at the end ptr, dont increase anymore
+                break;
+            }
+        }
+    }
+
+    // is iterator at the end?
+    [[nodiscard]] bool is_end() const noexcept { return b == set->nD; }
+
+    // returns the current Bucket
+    [[nodiscard]] bucket_pointer bucket() const noexcept { return set->buckets[b]; }
+
+  public:
+    explicit Iterator(size_type idx, size_type b, core_pointer set) noexcept
+        : idx{idx}, set{set}, b{b & (set->high_bit(b) - 1)} {
+        skip();
+    }
+
+    Iterator(core_pointer set) noexcept : idx{0}, set{set}, b{set->nD} {}  // for end-iterator
+    Iterator() noexcept : idx{0}, set{nullptr}, b{0} {}
+
+    // iterator converts to const_iterator
+    template <bool C = Const, typename = std::enable_if_t<C>>
+    Iterator(const Iterator<false>& other) noexcept : idx{other.idx}, set{other.set}, b{other.b} {}
+
+    [[nodiscard]] reference operator*() const noexcept { return bucket()->slots.ref(idx); }
+    [[nodiscard]] pointer operator->() const noexcept {
+        if constexpr (std::is_reference_v<reference>) {
+            return &**this;
+        } else {
+            return pointer{**this};
+        }
+    }
+
+    Iterator& operator++() noexcept {
+        if (++idx < bucket()->arrsz) {
+            return *this;
+        }
+
+        // if we are at the end of current bucket
+        idx = 0;
+        ++b;
+        if (b != set->nD) {  // if we are at the end ptr, dont skip to next valid ptr
+            skip();
+        }
+        return *this;
+    }
+
+    Iterator operator++(int) noexcept {
+        auto temp{*this};
+        ++(*this);
+        return temp;
+    }
+
+    // returns current position of iterator in format {Bucket number, Index in
+    // Bucker}, for debugging
+    std::pair<unsigned, unsigned> get_pos() const noexcept { return {b, idx}; }
+
+    [[nodiscard]] friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+        if (lhs.is_end() || rhs.is_end()) {  // if one of the iterators is the end iterator, test if both are
+            return lhs.is_end() && rhs.is_end();
+        }
+        return lhs.bucket() == rhs.bucket() && lhs.idx == rhs.idx;  // test if they point to the same element
+    }
+    [[nodiscard]] friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept { return !(lhs == rhs); }
+};
+
+#endif  // EH_CORE_H
@@ -0,0 +1,532 @@
+#ifndef EH_LINEAR_SET_H
+#define EH_LINEAR_SET_H
+
+#include "EH_set.h"
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+// Linear Hashing Set (Litwin), an alternative growth policy to the directory of EH_set.
+// Buckets are split one at a time in round robin order (Bucket split, then split + 1, ...), whenever the
+// load factor exceeds max_load. A key hashes to h mod 2^level, or to h mod 2^(level + 1) if that Bucket
+// was already split in this round. Since the overflowing Bucket is usually not the one that is split
+// next, Buckets take overflow Buckets in a chain.
+// There is no directory to double: Buckets live in fixed size segments, only the small table of
+// segments grows. So memory grows by one segment at a time and every insert splits at most one Bucket.
+template <typename Key, size_t N = 16> class EH_linear_set {
+  public:
+    class Iterator;
+    using value_type = Key;
+    using key_type = Key;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using const_iterator = Iterator;
+    using iterator = const_iterator;
+    using key_equal = std::equal_to<key_type>;
+    using hasher = std::hash<key_type>;
+
+    // a split is triggered once size > max_load * buckets * N
+    static constexpr double max_load{0.8};
+
+  private:
+    using slots_type = EH_key_slots<Key, N>;
+    static constexpr size_type segment_size{256};  // Buckets per segment
+
+    // only the first arrsz slots are constructed. Every Bucket of a chain but the last is full,
+    // and overflow Buckets are never empty
+    struct Bucket {
+        slots_type slots;
+        size_type arrsz{0};     // number of elems in Bucket
+        Bucket* next{nullptr};  // overflow Bucket
+
+        Bucket() noexcept {}  // user-provided, so the slots are not zeroed
+        Bucket(const Bucket&) = delete;
+        Bucket& operator=(const Bucket&) = delete;
+        ~Bucket() noexcept;
+    };
+
+    struct Segment {
+        Bucket buckets[segment_size];
+    };
+
+    size_type sz;                    // actual size
+    size_type level;                 // Buckets 0..2^level-1 exist at the start of a round
+    size_type split;                 // next Bucket to split
+    std::vector<Segment*> segments;  // Bucket i is in segments[i / segment_size]
+
+    [[nodiscard]] size_type address(size_type hash) const noexcept;
+    [[nodiscard]] Bucket& bucket(size_type i) const noexcept {
+        return segments[i / segment_size]->buckets[i % segment_size];
+    }
+    [[nodiscard]] static Bucket& last(Bucket& b) noexcept;
+    static void free_overflow(Bucket& b) noexcept;
+    void split_next() noexcept;
+
+  public:
+    EH_linear_set() noexcept;
+    EH_linear_set(std::initializer_list<key_type> ilist) noexcept;
+    template <typename InputIt> EH_linear_set(InputIt first, InputIt last) noexcept;
+    EH_linear_set(const EH_linear_set& other) noexcept;
+
+    ~EH_linear_set() noexcept;
+
+    EH_linear_set& operator=(const EH_linear_set& other) noexcept;
+
+    [[nodiscard]] size_type size() const noexcept;
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_type bucket_count() const noexcept;
+
+    std::pair<iterator, bool> insert(const key_type& key) noexcept;
+    template <typename InputIt> void insert(InputIt first, InputIt last) noexcept;
+
+    void clear() noexcept;
+
+    size_type erase(const key_type& key) noexcept;
+    [[nodiscard]] size_type count(const key_type& key) const noexcept;
+    [[nodiscard]] iterator find(const key_type& key) const noexcept;
+    template <typename F> void for_each(F f) const noexcept;
+
+    [[nodiscard]] const_iterator begin() const noexcept;
+    [[nodiscard]] const_iterator end() const noexcept;
+
+    void swap(EH_linear_set& other) noexcept;
+
+    void dump(std::ostream& o = std::cerr) const noexcept;
+
+    [[nodiscard]] friend bool operator==(const EH_linear_set& lhs, const EH_linear_set& rhs) noexcept {
+        if (lhs.sz != rhs.sz) {
+            return false;
+        }
+        for (const auto& key : rhs) {
+            if (!lhs.count(key)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+    [[nodiscard]] friend bool operator!=(const EH_linear_set& lhs, const EH_linear_set& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+};
+
+// growth policies for EH_hash_set
+struct EH_directory_growth {};  // EH_set: split the overflowing Bucket, double the directory if needed
+struct EH_linear_growth {};     // EH_linear_set: split Buckets round robin, no directory
+
+// set with the growth policy Growth, so both can be compared on the same code. Generic code may use the
+// interface both share: the constructors, copy and assignment, size, empty, insert (returning
+// {iterator, bool}) and range insert, erase, count, find, begin / end, for_each, clear, swap, ==, != and dump.
+// Everything else (emplace, the batched and set operations, snapshots, save / load, ...) is EH_set only
+template <typename Key, size_t N = 16, typename Growth = EH_directory_growth>
+using EH_hash_set =
+    std::conditional_t<std::is_same_v<Growth, EH_linear_growth>, EH_linear_set<Key, N>, EH_set<Key, N>>;
+
+/*--------------------------Bucket methods----------------------------*/
+
+// destroys the constructed slots, overflow Buckets are freed by free_overflow
+template <typename Key, size_t N> EH_linear_set<Key, N>::Bucket::~Bucket() noexcept {
+    for (size_type i{0}; i < arrsz; ++i) {
+        slots.destroy(i);
+    }
+}
+
+/*------------------------private methods---------------------*/
+
+// Bucket of a hash value: h mod 2^level, or h mod 2^(level + 1) if that Bucket was split in this round
+// O(1)
+template <typename Key, size_t N>
+typename EH_linear_set<Key, N>::size_type EH_linear_set<Key, N>::address(size_type hash) const noexcept {
+    size_type a{hash & ((size_type{1} << level) - 1)};
+    return a < split ? hash & ((size_type{2} << level) - 1) : a;
+}
+
+// last Bucket in the chain of b
+// O(chain length)
+template <typename Key, size_t N>
+typename EH_linear_set<Key, N>::Bucket& EH_linear_set<Key, N>::last(Bucket& b) noexcept {
+    Bucket* p{&b};
+    while (p->next) {
+        p = p->next;
+    }
+    return *p;
+}
+
+// frees every overflow Bucket behind b
+// O(chain length)
+template <typename Key, size_t N> void EH_linear_set<Key, N>::free_overflow(Bucket& b) noexcept {
+    Bucket* p{b.next};
+    b.next = nullptr;
+    while (p) {
+        Bucket* next{p->next};
+        delete p;
+        p = next;
+    }
+}
+
+// splits Bucket split into itself and Bucket split + 2^level by the next hash bit, then advances split
+// (and level at the end of a round). Keys that stay are compacted towards the front of the chain
+// O(N * chain length)
+template <typename Key, size_t N> void EH_linear_set<Key, N>::split_next() noexcept {
+    size_type bit{size_type{1} << level};
+    size_type to{split + bit};
+    if (to / segment_size == segments.size()) {
+        segments.push_back(new Segment{});
+    }
+    Bucket& head = bucket(split);
+    Bucket* dst{&bucket(to)};
+
+    Bucket* w{&head};  // next free position of the keys that stay
+    Bucket* w_prev{nullptr};
+    size_type wi{0};
+    for (Bucket* r{&head}; r; r = r->next) {
+        for (size_type i{0}; i < r->arrsz; ++i) {
+            if (hasher{}(r->slots.key(i)) & bit) {
+                if (dst->arrsz == N) {
+                    dst = dst->next = new Bucket{};
+                }
+                r->slots.relocate(i, dst->slots, dst->arrsz++);
+                continue;
+            }
+            if (r != w || i != wi) {
+                r->slots.relocate(i, w->slots, wi);
+            }
+            if (++wi == N && w->next) {
+                w_prev = w;
+                w = w->next;
+                wi = 0;
+            }
+        }
+    }
+
+    // every Bucket before w is full now, the slots behind position wi were all relocated
+    for (Bucket* p{&head}; p != w; p = p->next) {
+        p->arrsz = N;
+    }
+    for (Bucket* p{w->next}; p; p = p->next) {
+        p->arrsz = 0;
+    }
+    w->arrsz = wi;
+    free_overflow(*w);
+    if (wi == 0 && w_prev) {
+        free_overflow(*w_prev);
+    }
+
+    if (++split == bit) {
+        ++level;
+        split = 0;
+    }
+}
+
+/*---------------------------EH_linear_set methods-----------------------------*/
+
+// create empty set (empty set contains 1 Bucket)
+// O(1)
+template <typename Key, size_t N>
+EH_linear_set<Key, N>::EH_linear_set() noexcept : sz{0}, level{0}, split{0}, segments{new Segment{}} {}
+
+// calls range Constructor
+// O(list size)
+template <typename Key, size_t N>
+EH_linear_set<Key, N>::EH_linear_set(std::initializer_list<key_type> ilist) noexcept
+    : EH_linear_set{std::begin(ilist), std::end(ilist)} {}
+
+// calls range insert
+// O(range size)
+template <typename Key, size_t N>
+template <typename InputIt>
+EH_linear_set<Key, N>::EH_linear_set(InputIt first, InputIt last) noexcept : EH_linear_set{} {
+    insert(first, last);
+}
+
+// copies segments and chains Bucket by Bucket, so no key is hashed again
+// O(other.sz + Buckets)
+template <typename Key, size_t N>
+EH_linear_set<Key, N>::EH_linear_set(const EH_linear_set& other) noexcept
+    : sz{other.sz}, level{other.level}, split{other.split}, segments{} {
+    segments.reserve(other.segments.size());
+    for (size_type s{0}; s < other.segments.size(); ++s) {
+        segments.push_back(new Segment{});
+    }
+    for (size_type b{0}; b < bucket_count(); ++b) {
+        Bucket* dst{&bucket(b)};
+        for (const Bucket* src{&other.bucket(b)}; src; src = src->next) {
+            if (src != &other.bucket(b)) {
+                dst = dst->next = new Bucket{};
+            }
+            for (size_type i{0}; i < src->arrsz; ++i) {
+                dst->slots.copy_construct(i, src->slots, i);
+            }
+            dst->arrsz = src->arrsz;
+        }
+    }
+}
+
+// frees the overflow chains, then the segments
+// O(Buckets)
+template <typename Key, size_t N> EH_linear_set<Key, N>::~EH_linear_set() noexcept {
+    for (size_type i{0}; i < bucket_count(); ++i) {
+        free_overflow(bucket(i));
+    }
+    for (Segment* s : segments) {
+        delete s;
+    }
+}
+
+// copy and swap
+// O(other.sz + Buckets)
+template <typename Key, size_t N>
+EH_linear_set<Key, N>& EH_linear_set<Key, N>::operator=(const EH_linear_set& other) noexcept {
+    if (this != &other) {
+        EH_linear_set temp{other};
+        swap(temp);
+    }
+    return *this;
+}
+
+// O(1)
+template <typename Key, size_t N>
+typename EH_linear_set<Key, N>::size_type EH_linear_set<Key, N>::size() const noexcept {
+    return sz;
+}
+
+// O(1)
+template <typename Key, size_t N> bool EH_linear_set<Key, N>::empty() const noexcept { return sz == 0; }
+
+// number of Buckets, without overflow Buckets
+// O(1)
+template <typename Key, size_t N>
+typename EH_linear_set<Key, N>::size_type EH_linear_set<Key, N>::bucket_count() const noexcept {
+    return (size_type{1} << level) + split;
+}
+
+// appends key to the last Bucket of its chain, then splits the next Bucket if the set got too full
+// returns the iterator to key and true if key was inserted, false if it was already inside
+// O(1) expected
+template <typename Key, size_t N>
+std::pair<typename EH_linear_set<Key, N>::iterator, bool> EH_linear_set<Key, N>::insert(const key_type& key) noexcept {
+    size_type a{address(hasher{}(key))};
+    Bucket& head = bucket(a);
+    for (Bucket* p{&head}; p; p = p->next) {
+        for (size_type i{0}; i < p->arrsz; ++i) {
+            if (key_equal{}(key, p->slots.key(i))) {
+                return {iterator(i, p, a, this), false};
+            }
+        }
+    }
+    Bucket* b{&last(head)};
+    if (b->arrsz == N) {
+        b = b->next = new Bucket{};
+    }
+    b->slots.construct(b->arrsz++, key);
+    ++sz;
+
+    if (static_cast<double>(sz) > max_load * static_cast<double>(bucket_count() * N)) {
+        split_next();
+        return {find(key), true};  // the split may have moved key
+    }
+    return {iterator(b->arrsz - 1, b, a, this), true};
+}
+
+// inserts every key of the range
+// O(range size)
+template <typename Key, size_t N>
+template <typename InputIt>
+void EH_linear_set<Key, N>::insert(InputIt first, InputIt last) noexcept {
+    for (auto it{first}; it != last; ++it) {
+        insert(*it);
+    }
+}
+
+// swap with empty set
+// O(Buckets)
+template <typename Key, size_t N> void EH_linear_set<Key, N>::clear() noexcept {
+    EH_linear_set temp{};
+    swap(temp);
+}
+
+// overwrites key with the last key of its chain, an emptied overflow Bucket is freed
+// O(1) expected
+template <typename Key, size_t N>
+typename EH_linear_set<Key, N>::size_type EH_linear_set<Key, N>::erase(const key_type& key) noexcept {
+    Bucket& head = bucket(address(hasher{}(key)));
+    for (Bucket* p{&head}; p; p = p->next) {
+        for (size_type i{0}; i < p->arrsz; ++i) {
+            if (!key_equal{}(key, p->slots.key(i))) {
+                continue;
+            }
+            Bucket* prev{nullptr};
+            Bucket* end{&head};
+            for (; end->next; end = end->next) {
+                prev = end;
+            }
+            p->slots.destroy(i);
+            if (p != end || i != end->arrsz - 1) {
+                end->slots.relocate(end->arrsz - 1, p->slots, i);
+            }
+            if (--end->arrsz == 0 && prev) {
+                free_overflow(*prev);
+            }
+            --sz;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// walks the chain of the Bucket of key
+// O(1) expected
+template <typename Key, size_t N>
+typename EH_linear_set<Key, N>::size_type EH_linear_set<Key, N>::count(const key_type& key) const noexcept {
+    for (const Bucket* p{&bucket(address(hasher{}(key)))}; p; p = p->next) {
+        for (size_type i{0}; i < p->arrsz; ++i) {
+            if (key_equal{}(key, p->slots.key(i))) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// walks the chain of the Bucket of key
+// returns the iterator to key, or end() if it is not inside
+// O(1) expected
+template <typename Key, size_t N>
+typename EH_linear_set<Key, N>::iterator EH_linear_set<Key, N>::find(const key_type& key) const noexcept {
+    size_type a{address(hasher{}(key))};
+    for (const Bucket* p{&bucket(a)}; p; p = p->next) {
+        for (size_type i{0}; i < p->arrsz; ++i) {
+            if (key_equal{}(key, p->slots.key(i))) {
+                return iterator(i, p, a, this);
+            }
+        }
+    }
+    return end();
+}
+
+// calls f(key) for every key, f must not modify the set
+// O(Buckets + sz)
+template <typename Key, size_t N>
+template <typename F>
+void EH_linear_set<Key, N>::for_each(F f) const noexcept {
+    for (size_type b{0}; b < bucket_count(); ++b) {
+        for (const Bucket* p{&bucket(b)}; p; p = p->next) {
+            for (size_type i{0}; i < p->arrsz; ++i) {
+                f(p->slots.key(i));
+            }
+        }
+    }
+}
+
+// begin-iterator is the first key of the first non-empty Bucket
+// O(1) amortized over an iteration
+template <typename Key, size_t N>
+typename EH_linear_set<Key, N>::const_iterator EH_linear_set<Key, N>::begin() const noexcept {
+    return const_iterator(0, &bucket(0), 0, this);
+}
+
+// end-iterator is behind the last Bucket
+// O(1)
+template <typename Key, size_t N>
+typename EH_linear_set<Key, N>::const_iterator EH_linear_set<Key, N>::end() const noexcept {
+    return const_iterator(this);
+}
+
+// just uses std::swap for every instance variable
+// O(1)
+template <typename Key, size_t N> void EH_linear_set<Key, N>::swap(EH_linear_set& other) noexcept {
+    using std::swap;
+    swap(sz, other.sz);
+    swap(level, other.level);
+    swap(split, other.split);
+    swap(segments, other.segments);
+}
+
+// Outputs entire set to ostream, overflow Buckets follow their Bucket
+template <typename Key, size_t N> void EH_linear_set<Key, N>::dump(std::ostream& o) const noexcept {
+    o << "Linear Hashing <" << typeid(Key).name() << ',' << N << ">, level = " << level << ", split = " << split
+      << ", nB = " << bucket_count() << ", sz = " << sz << '\n';
+    for (size_type b{0}; b < bucket_count(); ++b) {
+        o << b << " -->";
+        for (const Bucket* p{&bucket(b)}; p; p = p->next) {
+            o << " [arrsz = " << p->arrsz << " | ";
+            for (size_type i{0}; i < p->arrsz; ++i) {
+                o << p->slots.key(i) << ' ';
+            }
+            o << ']';
+        }
+        o << '\n';
+    }
+}
+
+/*---------------------------Iterator Class-------------------------------*/
+
+// walks the Buckets in order and every chain front to back. Inserting or erasing invalidates it
+template <typename Key, size_t N> class EH_linear_set<Key, N>::Iterator {
+  public:
+    using value_type = Key;
+    using difference_type = std::ptrdiff_t;
+    using reference = const value_type&;
+    using pointer = const value_type*;
+    using iterator_category = std::forward_iterator_tag;
+
+  private:
+    size_type idx{0};
+    const Bucket* p{nullptr};  // Bucket of the chain of b, nullptr for the end-iterator
+    size_type b{0};
+    const EH_linear_set* set{nullptr};
+
+    // moves on to the next key if the current Bucket has none left, across chains and Buckets
+    void skip() noexcept {
+        while (p && idx == p->arrsz) {
+            idx = 0;
+            p = p->next;
+            while (!p && ++b < set->bucket_count()) {
+                p = &set->bucket(b);
+            }
+        }
+    }
+
+  public:
+    explicit Iterator(size_type idx, const Bucket* p, size_type b, const EH_linear_set* set) noexcept
+        : idx{idx}, p{p}, b{b}, set{set} {
+        skip();
+    }
+
+    Iterator(const EH_linear_set* set) noexcept : set{set} {}  // for end-iterator
+    Iterator() noexcept = default;
+
+    [[nodiscard]] reference operator*() const noexcept { return p->slots.key(idx); }
+    [[nodiscard]] pointer operator->() const noexcept { return &p->slots.key(idx); }
+
+    Iterator& operator++() noexcept {
+        ++idx;
+        skip();
+        return *this;
+    }
+
+    Iterator operator++(int) noexcept {
+        auto temp{*this};
+        ++(*this);
+        return temp;
+    }
+
+    [[nodiscard]] friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+        return lhs.p == rhs.p && (!lhs.p || lhs.idx == rhs.idx);
+    }
+    [[nodiscard]] friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept { return !(lhs == rhs); }
+};
+
+template <typename Key, size_t N> void swap(EH_linear_set<Key, N>& lhs, EH_linear_set<Key, N>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+#endif  // EH_LINEAR_SET_H
@@ -0,0 +1,392 @@
+#ifndef EH_MAP_H
+#define EH_MAP_H
+
+#include "EH_core.h"
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+// N slots holding key/value pairs, see EH_core
+// Split = true stores keys and values in two arrays, so probing a Bucket only reads keys,
+// Split = false stores them next to each other, so a hit finds its value on the same cache line
+template <typename Key, typename Value, size_t N, bool Split> struct EH_pair_slots;
+
+template <typename Key, typename Value, size_t N> struct EH_pair_slots<Key, Value, N, true> {
+    using key_type = Key;
+    using value_type = std::pair<const Key, Value>;
+    using reference = std::pair<const Key&, Value&>;
+    using const_reference = std::pair<const Key&, const Value&>;
+    static constexpr size_t capacity{N};
+    static constexpr bool trivially_copyable{std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>};
+    static constexpr bool indexed{false};
+    static constexpr bool ordered{false};
+
+    alignas(Key) unsigned char key_storage[N * sizeof(Key)];
+    alignas(Value) unsigned char value_storage[N * sizeof(Value)];
+
+    [[nodiscard]] Key* keys() noexcept { return std::launder(reinterpret_cast<Key*>(key_storage)); }
+    [[nodiscard]] const Key* keys() const noexcept { return std::launder(reinterpret_cast<const Key*>(key_storage)); }
+    [[nodiscard]] Value* values() noexcept { return std::launder(reinterpret_cast<Value*>(value_storage)); }
+    [[nodiscard]] const Value* values() const noexcept {
+        return std::launder(reinterpret_cast<const Value*>(value_storage));
+    }
+
+    [[nodiscard]] const Key& key(size_t i) const noexcept { return keys()[i]; }
+    [[nodiscard]] Value& value(size_t i) noexcept { return values()[i]; }
+    [[nodiscard]] const Value& value(size_t i) const noexcept { return values()[i]; }
+    [[nodiscard]] reference ref(size_t i) noexcept { return {key(i), value(i)}; }
+    [[nodiscard]] const_reference ref(size_t i) const noexcept { return {key(i), value(i)}; }
+
+    template <typename K, typename... Args> void construct(size_t i, K&& key, Args&&... args) noexcept {
+        ::new (static_cast<void*>(keys() + i)) Key(std::forward<K>(key));
+        ::new (static_cast<void*>(values() + i)) Value(std::forward<Args>(args)...);
+    }
+    void copy_construct(size_t i, const EH_pair_slots& src, size_t j) noexcept {
+        construct(i, src.key(j), src.value(j));
+    }
+    void relocate(size_t i, EH_pair_slots& dst, size_t j) noexcept {
+        dst.construct(j, std::move(keys()[i]), std::move(values()[i]));
+        destroy(i);
+    }
+    void destroy(size_t i) noexcept {
+        std::destroy_at(keys() + i);
+        std::destroy_at(values() + i);
+    }
+};
+
+template <typename Key, typename Value, size_t N> struct EH_pair_slots<Key, Value, N, false> {
+    using key_type = Key;
+    using value_type = std::pair<const Key, Value>;
+    using reference = std::pair<const Key&, Value&>;
+    using const_reference = std::pair<const Key&, const Value&>;
+    static constexpr size_t capacity{N};
+    static constexpr bool trivially_copyable{std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>};
+    static constexpr bool indexed{false};
+    static constexpr bool ordered{false};
+
+    struct entry {
+        Key key;
+        Value value;
+    };
+
+    alignas(entry) unsigned char storage[N * sizeof(entry)];
+
+    [[nodiscard]] entry* entries() noexcept { return std::launder(reinterpret_cast<entry*>(storage)); }
+    [[nodiscard]] const entry* entries() const noexcept {
+        return std::launder(reinterpret_cast<const entry*>(storage));
+    }
+
+    [[nodiscard]] const Key& key(size_t i) const noexcept { return entries()[i].key; }
+    [[nodiscard]] Value& value(size_t i) noexcept { return entries()[i].value; }
+    [[nodiscard]] const Value& value(size_t i) const noexcept { return entries()[i].value; }
+    [[nodiscard]] reference ref(size_t i) noexcept { return {key(i), value(i)}; }
+    [[nodiscard]] const_reference ref(size_t i) const noexcept { return {key(i), value(i)}; }
+
+    template <typename K, typename... Args> void construct(size_t i, K&& key, Args&&... args) noexcept {
+        ::new (static_cast<void*>(entries() + i)) entry{Key(std::forward<K>(key)), Value(std::forward<Args>(args)...)};
+    }
+    void copy_construct(size_t i, const EH_pair_slots& src, size_t j) noexcept {
+        construct(i, src.key(j), src.value(j));
+    }
+    void relocate(size_t i, EH_pair_slots& dst, size_t j) noexcept {
+        dst.construct(j, std::move(entries()[i].key), std::move(entries()[i].value));
+        destroy(i);
+    }
+    void destroy(size_t i) noexcept { std::destroy_at(entries() + i); }
+};
+
+// Extendible Hashing Map, shares directory and Buckets with EH_set (see EH_core)
+// Iterators hand out std::pair<const Key&, Value&> proxies instead of references to a stored pair,
+// so keys and values can be kept in separate arrays.
+template <typename Key, typename Value, size_t N = 16, bool Split = true> class EH_map {
+    using slots_type = EH_pair_slots<Key, Value, N, Split>;
+    using core_type = EH_core<slots_type>;
+
+  public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<const Key, Value>;
+    using reference = typename slots_type::reference;
+    using const_reference = typename slots_type::const_reference;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using iterator = typename core_type::iterator;
+    using const_iterator = typename core_type::const_iterator;
+    using key_equal = std::equal_to<key_type>;
+    using hasher = std::hash<key_type>;
+
+  private:
+    core_type core;
+
+  public:
+    EH_map() noexcept = default;
+    EH_map(std::initializer_list<value_type> ilist) noexcept;
+    template <typename InputIt> EH_map(InputIt first, InputIt last) noexcept;
+    EH_map(const EH_map& other) noexcept = default;
+
+    ~EH_map() noexcept = default;
+
+    EH_map& operator=(const EH_map& other) noexcept;
+    EH_map& operator=(std::initializer_list<value_type> ilist) noexcept;
+
+    [[nodiscard]] size_type size() const noexcept;
+    [[nodiscard]] bool empty() const noexcept;
+
+    mapped_type& operator[](const key_type& key) noexcept;
+    mapped_type& operator[](key_type&& key) noexcept;
+
+    template <typename... Args> std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) noexcept;
+    template <typename... Args> std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args) noexcept;
+    template <typename M> std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj) noexcept;
+    template <typename M> std::pair<iterator, bool> insert_or_assign(key_type&& key, M&& obj) noexcept;
+
+    void insert(std::initializer_list<value_type> ilist) noexcept;
+    std::pair<iterator, bool> insert(const value_type& value) noexcept;
+    template <typename InputIt> void insert(InputIt first, InputIt last) noexcept;
+
+    void clear() noexcept;
+
+    size_type erase(const key_type& key) noexcept;
+    [[nodiscard]] size_type count(const key_type& key) const noexcept;
+    [[nodiscard]] iterator find(const key_type& key) noexcept;
+    [[nodiscard]] const_iterator find(const key_type& key) const noexcept;
+    void count_batch(const key_type* keys, size_type n, bool* out) const noexcept;
+    void find_batch(const key_type* keys, size_type n, const_iterator* out) const noexcept;
+
+    void swap(EH_map& other) noexcept;
+
+    [[nodiscard]] iterator begin() noexcept;
+    [[nodiscard]] iterator end() noexcept;
+    [[nodiscard]] const_iterator begin() const noexcept;
+    [[nodiscard]] const_iterator end() const noexcept;
+
+    void dump(std::ostream& o = std::cerr) const noexcept;
+
+    // compares Bucket by Bucket, aligned on the smaller local depth (see EH_core::equal),
+    // values of equal keys are compared with std::equal_to
+    // O(1) if sizes differ, O(lhs.nD + lhs.sz) otherwise
+    [[nodiscard]] friend bool operator==(const EH_map& lhs, const EH_map& rhs) noexcept {
+        return lhs.core.equal(rhs.core, [](const slots_type& l, size_type i, const slots_type& r, size_type j) {
+            return std::equal_to<mapped_type>{}(l.value(i), r.value(j));
+        });
+    }
+    [[nodiscard]] friend bool operator!=(const EH_map& lhs, const EH_map& rhs) noexcept { return !(lhs == rhs); }
+};
+
+/*---------------------------EH_map methods-----------------------------*/
+
+// calls it Constructor
+// O(list size)
+template <typename Key, typename Value, size_t N, bool Split>
+EH_map<Key, Value, N, Split>::EH_map(std::initializer_list<value_type> ilist) noexcept
+    : EH_map{std::begin(ilist), std::end(ilist)} {}
+
+// calls range insert
+// O(it range)
+template <typename Key, typename Value, size_t N, bool Split>
+template <typename InputIt>
+EH_map<Key, Value, N, Split>::EH_map(InputIt first, InputIt last) noexcept : EH_map{} {
+    insert(first, last);
+}
+
+// copies the directory shape and Buckets of other, reusing the Buckets of this (see EH_core::assign)
+// O(nD + other.nD + other.sz)
+template <typename Key, typename Value, size_t N, bool Split>
+EH_map<Key, Value, N, Split>& EH_map<Key, Value, N, Split>::operator=(const EH_map& other) noexcept {
+    core.assign(other.core);
+    return *this;
+}
+
+// clears all values, without losing structure and inserts ilist
+// O(nD + list size)
+template <typename Key, typename Value, size_t N, bool Split>
+EH_map<Key, Value, N, Split>& EH_map<Key, Value, N, Split>::operator=(std::initializer_list<value_type> ilist) noexcept {
+    core.clear_keys();
+    insert(ilist);
+    return *this;
+}
+
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+typename EH_map<Key, Value, N, Split>::size_type EH_map<Key, Value, N, Split>::size() const noexcept {
+    return core.size();
+}
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split> bool EH_map<Key, Value, N, Split>::empty() const noexcept {
+    return (core.size() == 0);
+}
+
+// value of key, value initialized if key is not inside yet
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+typename EH_map<Key, Value, N, Split>::mapped_type& EH_map<Key, Value, N, Split>::operator[](const key_type& key) noexcept {
+    return core.add(true, key).first->second;
+}
+
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+typename EH_map<Key, Value, N, Split>::mapped_type& EH_map<Key, Value, N, Split>::operator[](key_type&& key) noexcept {
+    return core.add(true, std::move(key)).first->second;
+}
+
+// constructs the value from args if key is not inside yet, otherwise key and args are left untouched
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+template <typename... Args>
+std::pair<typename EH_map<Key, Value, N, Split>::iterator, bool>
+EH_map<Key, Value, N, Split>::try_emplace(const key_type& key, Args&&... args) noexcept {
+    return core.add(true, key, std::forward<Args>(args)...);
+}
+
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+template <typename... Args>
+std::pair<typename EH_map<Key, Value, N, Split>::iterator, bool>
+EH_map<Key, Value, N, Split>::try_emplace(key_type&& key, Args&&... args) noexcept {
+    return core.add(true, std::move(key), std::forward<Args>(args)...);
+}
+
+// inserts obj if key is not inside yet, otherwise assigns obj to the value of key
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+template <typename M>
+std::pair<typename EH_map<Key, Value, N, Split>::iterator, bool>
+EH_map<Key, Value, N, Split>::insert_or_assign(const key_type& key, M&& obj) noexcept {
+    auto res{core.add(true, key, std::forward<M>(obj))};
+    if (!res.second) {
+        res.first->second = std::forward<M>(obj);  // obj was not consumed by add
+    }
+    return res;
+}
+
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+template <typename M>
+std::pair<typename EH_map<Key, Value, N, Split>::iterator, bool>
+EH_map<Key, Value, N, Split>::insert_or_assign(key_type&& key, M&& obj) noexcept {
+    auto res{core.add(true, std::move(key), std::forward<M>(obj))};
+    if (!res.second) {
+        res.first->second = std::forward<M>(obj);  // obj was not consumed by add
+    }
+    return res;
+}
+
+// insert list: calls iterator insert
+// O(list size)
+template <typename Key, typename Value, size_t N, bool Split>
+void EH_map<Key, Value, N, Split>::insert(std::initializer_list<value_type> ilist) noexcept {
+    insert(std::begin(ilist), std::end(ilist));
+}
+
+// inserts value if its key is not inside yet
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+std::pair<typename EH_map<Key, Value, N, Split>::iterator, bool>
+EH_map<Key, Value, N, Split>::insert(const value_type& value) noexcept {
+    return core.add(true, value.first, value.second);
+}
+
+// iterator insert adds every pair (the first one wins for duplicate keys)
+// O(range size)
+template <typename Key, typename Value, size_t N, bool Split>
+template <typename InputIt>
+void EH_map<Key, Value, N, Split>::insert(InputIt first, InputIt last) noexcept {
+    for (auto it{first}; it != last; ++it) {
+        core.add(true, (*it).first, (*it).second);
+    }
+}
+
+// swap with empty map
+// O(nD) (because Destruktor)
+template <typename Key, typename Value, size_t N, bool Split> void EH_map<Key, Value, N, Split>::clear() noexcept {
+    core.clear();
+}
+
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+typename EH_map<Key, Value, N, Split>::size_type EH_map<Key, Value, N, Split>::erase(const key_type& key) noexcept {
+    return core.erase(key);
+}
+
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+typename EH_map<Key, Value, N, Split>::size_type EH_map<Key, Value, N, Split>::count(const key_type& key) const noexcept {
+    return core.count(key);
+}
+
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+typename EH_map<Key, Value, N, Split>::iterator EH_map<Key, Value, N, Split>::find(const key_type& key) noexcept {
+    return core.find(key);
+}
+
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+typename EH_map<Key, Value, N, Split>::const_iterator
+EH_map<Key, Value, N, Split>::find(const key_type& key) const noexcept {
+    return core.find(key);
+}
+
+// batched count: out[i] is set if keys[i] is in the map
+// O(n)
+template <typename Key, typename Value, size_t N, bool Split>
+void EH_map<Key, Value, N, Split>::count_batch(const key_type* keys, size_type n, bool* out) const noexcept {
+    core.count_batch(keys, n, out);
+}
+
+// batched find: out[i] is the iterator to keys[i], or end() if not found
+// O(n)
+template <typename Key, typename Value, size_t N, bool Split>
+void EH_map<Key, Value, N, Split>::find_batch(const key_type* keys, size_type n, const_iterator* out) const noexcept {
+    core.find_batch(keys, n, out);
+}
+
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+void EH_map<Key, Value, N, Split>::swap(EH_map& other) noexcept {
+    core.swap(other.core);
+}
+
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+typename EH_map<Key, Value, N, Split>::iterator EH_map<Key, Value, N, Split>::begin() noexcept {
+    return core.begin();
+}
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+typename EH_map<Key, Value, N, Split>::iterator EH_map<Key, Value, N, Split>::end() noexcept {
+    return core.end();
+}
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+typename EH_map<Key, Value, N, Split>::const_iterator EH_map<Key, Value, N, Split>::begin() const noexcept {
+    return core.begin();
+}
+// O(1)
+template <typename Key, typename Value, size_t N, bool Split>
+typename EH_map<Key, Value, N, Split>::const_iterator EH_map<Key, Value, N, Split>::end() const noexcept {
+    return core.end();
+}
+
+// Outputs entire map to ostream, elements are printed as key:value
+template <typename Key, typename Value, size_t N, bool Split>
+void EH_map<Key, Value, N, Split>::dump(std::ostream& o) const noexcept {
+    o << "Extendible Hashing Map <" << typeid(Key).name() << ',' << typeid(Value).name() << ',' << N
+      << ">, d = " << core.depth() << ", nD = " << core.directory_size() << ", sz = " << core.size() << '\n';
+    core.dump(o, [](std::ostream& o, const slots_type& slots, size_type i) {
+        o << slots.key(i) << ':' << slots.value(i);
+    });
+}
+
+template <typename Key, typename Value, size_t N, bool Split>
+void swap(EH_map<Key, Value, N, Split>& lhs, EH_map<Key, Value, N, Split>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+#endif  // EH_MAP_H
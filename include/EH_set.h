@@ -1,76 +1,354 @@
 #ifndef EH_SET_H
 #define EH_SET_H
 
+#include "EH_core.h"
+
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+// N slots holding keys only, see EH_core
+template <typename Key, size_t N> struct EH_key_slots {
+    using key_type = Key;
+    using value_type = Key;
+    using reference = const Key&;
+    using const_reference = const Key&;
+    static constexpr size_t capacity{N};
+    static constexpr bool trivially_copyable{std::is_trivially_copyable_v<Key>};
+    static constexpr bool indexed{false};
+    static constexpr bool ordered{false};
+
+    alignas(Key) unsigned char storage[N * sizeof(Key)];
+
+    [[nodiscard]] Key* keys() noexcept { return std::launder(reinterpret_cast<Key*>(storage)); }
+    [[nodiscard]] const Key* keys() const noexcept { return std::launder(reinterpret_cast<const Key*>(storage)); }
+
+    [[nodiscard]] const Key& key(size_t i) const noexcept { return keys()[i]; }
+    [[nodiscard]] const Key& ref(size_t i) const noexcept { return keys()[i]; }
+
+    template <typename K> void construct(size_t i, K&& key) noexcept {
+        ::new (static_cast<void*>(keys() + i)) Key(std::forward<K>(key));
+    }
+    void copy_construct(size_t i, const EH_key_slots& src, size_t j) noexcept { construct(i, src.key(j)); }
+    void relocate(size_t i, EH_key_slots& dst, size_t j) noexcept {
+        dst.construct(j, std::move(keys()[i]));
+        destroy(i);
+    }
+    void destroy(size_t i) noexcept { std::destroy_at(keys() + i); }
+    void restore(size_t) noexcept {}  // nothing to rebuild after raw writes
+};
+
+// N slots holding keys like EH_key_slots, plus a Robin Hood hash index of their positions, so finding a
+// key in a large Bucket takes about two probes instead of a scan over all keys. The index has at least
+// 1.5 entries per slot and is addressed by the top bits of the mixed hash, which are independent of the
+// low bits the directory uses. An entry stores its probe distance, so only entries whose home is the
+// home of the key are compared, and a miss stops at the first entry closer to its home.
+// Keys stay dense in slots 0..arrsz-1, every slot operation updates the index.
+template <typename Key, size_t N> struct EH_indexed_key_slots {
+    static_assert(N < UINT16_MAX, "slot positions are stored in 16 bits");
+
+    using key_type = Key;
+    using value_type = Key;
+    using reference = const Key&;
+    using const_reference = const Key&;
+    static constexpr size_t capacity{N};
+    static constexpr bool trivially_copyable{std::is_trivially_copyable_v<Key>};
+    static constexpr bool indexed{true};
+    static constexpr bool ordered{false};
+
+    // probe distance + 1 (0 for an empty entry) and slot of the key
+    struct entry {
+        uint16_t dist;
+        uint16_t pos;
+    };
+
+    [[nodiscard]] static constexpr size_t index_bits() noexcept {
+        size_t bits{1};
+        while ((size_t{1} << bits) < N + N / 2) {
+            ++bits;
+        }
+        return bits;
+    }
+    static constexpr size_t index_size{size_t{1} << index_bits()};
+
+    alignas(Key) unsigned char storage[N * sizeof(Key)];
+    entry index[index_size];
+
+    [[nodiscard]] Key* keys() noexcept { return std::launder(reinterpret_cast<Key*>(storage)); }
+    [[nodiscard]] const Key* keys() const noexcept { return std::launder(reinterpret_cast<const Key*>(storage)); }
+
+    [[nodiscard]] const Key& key(size_t i) const noexcept { return keys()[i]; }
+    [[nodiscard]] const Key& ref(size_t i) const noexcept { return keys()[i]; }
+
+    // index entry a key probes first (splitmix64 finalizer of its hash)
+    [[nodiscard]] static size_t home(const Key& key) noexcept {
+        uint64_t z{std::hash<Key>{}(key)};
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return static_cast<size_t>((z ^ (z >> 31)) >> (64 - index_bits()));
+    }
+
+    void reset() noexcept { std::fill(index, index + index_size, entry{0, 0}); }
+
+    // returns the slot of key, or capacity
+    [[nodiscard]] size_t find(const Key& k, size_t) const noexcept {
+        size_t e{home(k)};
+        for (uint16_t dist{1}; index[e].dist >= dist; ++dist, e = (e + 1) & (index_size - 1)) {
+            if (index[e].dist == dist && std::equal_to<Key>{}(k, key(index[e].pos))) {
+                return index[e].pos;
+            }
+        }
+        return N;
+    }
+
+    // adds slot i to the index, an entry that is closer to its home than the new one yields its place
+    void link(size_t i) noexcept {
+        entry add{1, static_cast<uint16_t>(i)};
+        for (size_t e{home(key(i))}; ; e = (e + 1) & (index_size - 1), ++add.dist) {
+            if (index[e].dist == 0) {
+                index[e] = add;
+                return;
+            }
+            if (index[e].dist < add.dist) {
+                std::swap(add, index[e]);
+            }
+        }
+    }
+
+    // entry of slot i
+    [[nodiscard]] size_t entry_of(size_t i) const noexcept {
+        size_t e{home(key(i))};
+        while (index[e].dist == 0 || index[e].pos != i) {
+            e = (e + 1) & (index_size - 1);
+        }
+        return e;
+    }
+
+    // removes slot i from the index, the entries behind it move one step closer to their home
+    void unlink(size_t i) noexcept {
+        size_t e{entry_of(i)};
+        for (size_t next{(e + 1) & (index_size - 1)}; index[next].dist > 1; next = (next + 1) & (index_size - 1)) {
+            index[e] = {static_cast<uint16_t>(index[next].dist - 1), index[next].pos};
+            e = next;
+        }
+        index[e] = entry{0, 0};
+    }
+
+    // rebuilds the index after the first n slots were filled with raw bytes
+    void restore(size_t n) noexcept {
+        reset();
+        for (size_t i{0}; i < n; ++i) {
+            link(i);
+        }
+    }
+
+    template <typename K> void construct(size_t i, K&& key) noexcept {
+        ::new (static_cast<void*>(keys() + i)) Key(std::forward<K>(key));
+        link(i);
+    }
+    void copy_construct(size_t i, const EH_indexed_key_slots& src, size_t j) noexcept { construct(i, src.key(j)); }
+    void relocate(size_t i, EH_indexed_key_slots& dst, size_t j) noexcept {
+        if (&dst == this) {  // moving within the Bucket only retargets the entry
+            index[entry_of(i)].pos = static_cast<uint16_t>(j);
+            ::new (static_cast<void*>(keys() + j)) Key(std::move(keys()[i]));
+        } else {
+            unlink(i);
+            dst.construct(j, std::move(keys()[i]));
+        }
+        std::destroy_at(keys() + i);
+    }
+    void destroy(size_t i) noexcept {
+        unlink(i);
+        std::destroy_at(keys() + i);
+    }
+};
+
+// N slots holding keys in ascending order (std::less), for integer like keys. A lookup is a branchless
+// binary search over the keys: log2(N) steps whose loads do not depend on a branch prediction.
+// Inserting or removing a key shifts the keys behind it with memmove, splits keep the order.
+template <typename Key, size_t N> struct EH_sorted_key_slots {
+    static_assert(std::is_trivially_copyable_v<Key>, "sorted Buckets shift their keys with memmove");
 
-#if defined(DEBUG)
-#define TRACE(x) std::cerr << x << std::endl;
-#else
-#define TRACE(x)
-#endif
+    using key_type = Key;
+    using value_type = Key;
+    using reference = const Key&;
+    using const_reference = const Key&;
+    static constexpr size_t capacity{N};
+    static constexpr bool trivially_copyable{true};
+    static constexpr bool indexed{true};
+    static constexpr bool ordered{true};
+
+    alignas(Key) unsigned char storage[N * sizeof(Key)];
+
+    [[nodiscard]] Key* keys() noexcept { return std::launder(reinterpret_cast<Key*>(storage)); }
+    [[nodiscard]] const Key* keys() const noexcept { return std::launder(reinterpret_cast<const Key*>(storage)); }
+
+    [[nodiscard]] const Key& key(size_t i) const noexcept { return keys()[i]; }
+    [[nodiscard]] const Key& ref(size_t i) const noexcept { return keys()[i]; }
+
+    // first of the n slots whose key is not less than k (n if there is none)
+    [[nodiscard]] size_t lower_bound(const Key& k, size_t n) const noexcept {
+        if (n == 0) {
+            return 0;
+        }
+        const Key* base{keys()};
+        while (n > 1) {
+            size_t half{n / 2};
+            if (half * sizeof(Key) > 64) {  // both possible probes of the next step are on other cache lines
+                PREFETCH(base + half / 2);
+                PREFETCH(base + half + half / 2);
+            }
+            base += half * std::less<Key>{}(base[half - 1], k);  // a multiply, not a branch
+            n -= half;
+        }
+        return static_cast<size_t>(base - keys()) + std::less<Key>{}(*base, k);
+    }
+
+    void reset() noexcept {}
+
+    // returns the slot of key among the first n, or capacity
+    [[nodiscard]] size_t find(const Key& k, size_t n) const noexcept {
+        size_t i{lower_bound(k, n)};
+        return i < n && std::equal_to<Key>{}(k, key(i)) ? i : N;
+    }
+
+    // moves the key in slot i to its place among slots 0..i-1
+    size_t sift(size_t i) noexcept {
+        const Key k{keys()[i]};
+        size_t at{lower_bound(k, i)};
+        std::memmove(static_cast<void*>(keys() + at + 1), keys() + at, (i - at) * sizeof(Key));
+        keys()[at] = k;
+        return at;
+    }
+    void remove(size_t i, size_t n) noexcept {
+        std::memmove(static_cast<void*>(keys() + i), keys() + i + 1, (n - i - 1) * sizeof(Key));
+    }
+    // merges the m keys of src into the first n, skipping keys inside already, returns the new count
+    // counts the new keys in a first pass, then fills from the back, so every key moves at most once
+    size_t merge(size_t n, const EH_sorted_key_slots& src, size_t m) noexcept {
+        size_t fresh{0};
+        for (size_t i{0}, j{0}; j < m;) {
+            if (i < n && std::less<Key>{}(key(i), src.key(j))) {
+                ++i;
+                continue;
+            }
+            fresh += !(i < n && std::equal_to<Key>{}(key(i), src.key(j)));
+            ++j;
+        }
+        Key* k{keys()};
+        size_t i{n};
+        size_t out{n + fresh};
+        for (size_t j{m}; out != i;) {  // equal positions: every key of src is placed, the rest stays
+            if (i > 0 && !std::less<Key>{}(k[i - 1], src.key(j - 1))) {
+                j -= std::equal_to<Key>{}(k[i - 1], src.key(j - 1));
+                k[--out] = k[--i];
+            } else {
+                k[--out] = src.key(--j);
+            }
+        }
+        return n + fresh;
+    }
+    // sorts keys written as raw bytes
+    void restore(size_t n) noexcept { std::sort(keys(), keys() + n, std::less<Key>{}); }
+
+    template <typename K> void construct(size_t i, K&& key) noexcept {
+        ::new (static_cast<void*>(keys() + i)) Key(std::forward<K>(key));
+    }
+    void copy_construct(size_t i, const EH_sorted_key_slots& src, size_t j) noexcept { construct(i, src.key(j)); }
+    void relocate(size_t i, EH_sorted_key_slots& dst, size_t j) noexcept { dst.construct(j, keys()[i]); }
+    void destroy(size_t) noexcept {}
+};
+
+// Bucket layouts of EH_set, Layout::slots<Key, N> are the Slots of its core
+// scans all keys of a Bucket, fastest for small N
+struct EH_scan_layout {
+    template <typename Key, size_t N> using slots = EH_key_slots<Key, N>;
+};
+// keeps a hash index over the keys of every Bucket, for large N (about 128 and up)
+struct EH_indexed_layout {
+    template <typename Key, size_t N> using slots = EH_indexed_key_slots<Key, N>;
+};
+// keeps the keys of every Bucket sorted and binary searches them, for trivially copyable ordered keys
+struct EH_sorted_layout {
+    template <typename Key, size_t N> using slots = EH_sorted_key_slots<Key, N>;
+};
+
+// Extendible Hashing Set of Keys, N keys per Bucket
+// Digest keeps an order independent checksum of the keys, so unequal sets are rejected in O(1)
+// and copies of a set can locate the hash prefixes they differ in (see digest)
+// SplitPolicy decides when a Bucket is split, EH_split_at_fill and EH_split_at_probe split before a
+// Bucket is full to keep lookups short, EH_split_deferred adds a slot per Bucket to postpone doubling
+// Layout decides how a Bucket finds its keys (EH_scan_layout, EH_indexed_layout or EH_sorted_layout)
+template <typename Key, size_t N = 16, bool Digest = false, typename SplitPolicy = EH_split_on_overflow,
+          typename Layout = EH_scan_layout>
+class EH_set {
+    using slots_type = typename Layout::template slots<Key, N + SplitPolicy::spare>;
+    using core_type = EH_core<slots_type, Digest, SplitPolicy>;
 
-template <typename Key, size_t N = 16> class EH_set {
   public:
-    class Iterator;
     using value_type = Key;
     using key_type = Key;
     using reference = value_type&;
     using const_reference = const value_type&;
     using size_type = size_t;
     using difference_type = std::ptrdiff_t;
-    using const_iterator = Iterator;
+    using const_iterator = typename core_type::const_iterator;
     using iterator = const_iterator;
     using key_equal = std::equal_to<key_type>;
     using hasher = std::hash<key_type>;
 
   private:
-    struct Bucket {
-        key_type elements[N];
-        size_type l{0};      // local depth
-        size_type arrsz{0};  // number of elems in Bucket
-
-        size_type append(const key_type& elem) noexcept;
-        size_type remove(const key_type& elem) noexcept;
-        [[nodiscard]] size_type find(const key_type& elem) const noexcept;
-        [[nodiscard]] inline size_type high_bit() const noexcept;
-    };
-
-    size_type sz;  // actual size
-    size_type d;   // global depth
-    size_type nD;  // 2^d
-    Bucket** buckets;
+    core_type core;
 
-    void expansion() noexcept;
-    void split_bucket(size_type hash) noexcept;
-    iterator add(key_type k, bool check = true) noexcept;
+    struct snapshot_tag {};
+    EH_set(const EH_set& other, snapshot_tag) noexcept : core{other.core.snapshot()} {}
 
   public:
-    EH_set() noexcept;
+    EH_set() noexcept = default;
     EH_set(std::initializer_list<key_type> ilist) noexcept;
     template <typename InputIt> EH_set(InputIt first, InputIt last) noexcept;
-    EH_set(const EH_set& other) noexcept;
+    EH_set(const EH_set& other) noexcept = default;
+
+    ~EH_set() noexcept = default;
 
-    ~EH_set() noexcept;
+    [[nodiscard]] EH_set snapshot() const noexcept;
 
     EH_set& operator=(const EH_set& other) noexcept;
     EH_set& operator=(std::initializer_list<key_type> ilist) noexcept;
 
     [[nodiscard]] size_type size() const noexcept;
     [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_type depth() const noexcept;
 
     void insert(std::initializer_list<key_type> ilist) noexcept;
     std::pair<iterator, bool> insert(const key_type& key) noexcept;
+    std::pair<iterator, bool> insert(key_type&& key) noexcept;
+    template <typename... Args> std::pair<iterator, bool> emplace(Args&&... args) noexcept;
     template <typename InputIt> void insert(InputIt first, InputIt last) noexcept;
+    void insert_batch(const key_type* keys, size_type n) noexcept;
+    void reserve(size_type n) noexcept;
+
+    void merge(const EH_set& other) noexcept;
 
     void clear() noexcept;
 
     size_type erase(const key_type& key) noexcept;
     [[nodiscard]] size_type count(const key_type& key) const noexcept;
     [[nodiscard]] iterator find(const key_type& key) const noexcept;
+    void count_batch(const key_type* keys, size_type n, bool* out) const noexcept;
+    void find_batch(const key_type* keys, size_type n, iterator* out) const noexcept;
+
+    [[nodiscard]] size_type digest(size_type prefix = 0, size_type bits = 0) const noexcept;
+    template <typename F> void for_each(size_type prefix, size_type bits, F f) const noexcept;
 
     void swap(EH_set& other) noexcept;
 
@@ -78,402 +356,321 @@ template <typename Key, size_t N = 16> class EH_set {
     [[nodiscard]] const_iterator end() const noexcept;
 
     void dump(std::ostream& o = std::cerr) const noexcept;
+    bool save(std::ostream& o) const noexcept;
+    bool load(std::istream& in) noexcept;
 
-    // goes through every key in lhs once and calls count for rhs
-    // O(lhs.sz)
+    // compares Bucket by Bucket, aligned on the smaller local depth (see EH_core::equal)
+    // O(1) if sizes (or checksums with Digest) differ, O(lhs.nD + lhs.sz) otherwise
     [[nodiscard]] friend bool operator==(const EH_set& lhs, const EH_set& rhs) noexcept {
-        if (lhs.sz != rhs.sz) {
-            return false;
-        }
-        for (const auto& key : rhs) {
-            if (!lhs.count(key)) {
-                return false;
-            }
-        }
-
-        return true;
+        return lhs.core.equal(rhs.core, [](const auto&, size_type, const auto&, size_type) { return true; });
     }
     [[nodiscard]] friend bool operator!=(const EH_set& lhs, const EH_set& rhs) noexcept { return !(lhs == rhs); }
-};
-
-/*--------------------------Bucket methods----------------------------*/
-
-// Append Element to Bucket
-// returns 1 if Element could be inserted, 0 otherwise
-// O(1)
-template <typename Key, size_t N>
-typename EH_set<Key, N>::size_type EH_set<Key, N>::Bucket::append(const key_type& elem) noexcept {
-    if (arrsz == N) {
-        return 0;
-    }
-    elements[arrsz++] = elem;
-    return 1;
-}
-
-// find Element in Bucket
-// returns index of Element in Bucket, if found, and N otherwise
-// O(N) = O(1)
-template <typename Key, size_t N>
-typename EH_set<Key, N>::size_type EH_set<Key, N>::Bucket::find(const key_type& elem) const noexcept {
-    for (size_type i{0}; i < arrsz; ++i) {
-        if (key_equal{}(elem, elements[i])) {
-            return i;
-        }
-    }
-    return N;
-}
 
-// Remove Element in Bucket
-// swap with last element and decrease size
-// O(N) = O(1)
-template <typename Key, size_t N>
-typename EH_set<Key, N>::size_type EH_set<Key, N>::Bucket::remove(const key_type& elem) noexcept {
-    for (size_type i{0}; i < arrsz; ++i) {
-        if (key_equal{}(elem, elements[i])) {
-            if (i != --arrsz) {
-                std::swap(elements[i], elements[arrsz]);
-            }
-            return 1;
-        }
+    // keys in lhs or rhs: copies the larger set and merges the smaller one into it
+    // O(lhs.nD + rhs.nD + lhs.sz + rhs.sz)
+    [[nodiscard]] friend EH_set set_union(const EH_set& lhs, const EH_set& rhs) noexcept {
+        const bool lhs_larger{lhs.size() >= rhs.size()};
+        EH_set res{lhs_larger ? lhs : rhs};
+        res.merge(lhs_larger ? rhs : lhs);
+        return res;
     }
-    return 0;
-}
 
-// returns highest bit that bucket elems agree on
-template <typename Key, size_t N>
-inline typename EH_set<Key, N>::size_type EH_set<Key, N>::Bucket::high_bit() const noexcept {
-    return 1 << l;
-}
-
-/*------------------------private methods---------------------*/
-
-// May call expansion and split multiple times
-// O(1)
-template <typename Key, size_t N>
-typename EH_set<Key, N>::iterator EH_set<Key, N>::add(key_type k, bool check) noexcept {
-    size_type hash = hasher{}(k) & (nD - 1);
-    size_type idx{0};
-    if (check && (idx = buckets[hash]->find(k)) != N) {
-        return iterator(idx, hash, this);  // if already inside, skip
+    // keys in lhs and rhs: copies the smaller set and drops the keys the other one misses
+    // O(min(lhs.nD + lhs.sz, rhs.nD + rhs.sz))
+    [[nodiscard]] friend EH_set set_intersection(const EH_set& lhs, const EH_set& rhs) noexcept {
+        const bool lhs_smaller{lhs.size() <= rhs.size()};
+        EH_set res{lhs_smaller ? lhs : rhs};
+        res.core.retain((lhs_smaller ? rhs : lhs).core, true);
+        return res;
     }
 
-    while (true) {  // while key can't be inserted
-        if (buckets[hash]->append(k)) {
-            sz++;   // successful insert
-            return iterator(buckets[hash]->arrsz - 1, hash, this);
-        }
-        // bucket overflow, split (and expansion) necessary
-        split_bucket(hash);
-        hash = hasher{}(k) & (nD - 1);
-    }
-}
-
-// doubles the pointer array
-// O(1)
-template <typename Key, size_t N> void EH_set<Key, N>::expansion() noexcept {
-    size_type new_nD = 1 << ++d;
-    Bucket** new_buckets{new Bucket*[new_nD]};
-    for (size_type i{0}; i < nD; ++i) {
-        new_buckets[i] = buckets[i];
-        new_buckets[i + nD] = buckets[i];  // pointer repeat with offset nD
+    // keys in lhs but not in rhs: copies lhs and drops the keys rhs contains
+    // O(lhs.nD + lhs.sz)
+    [[nodiscard]] friend EH_set set_difference(const EH_set& lhs, const EH_set& rhs) noexcept {
+        EH_set res{lhs};
+        res.core.retain(rhs.core, false);
+        return res;
     }
-    delete[] buckets;
-    buckets = new_buckets;
-    nD = new_nD;
-}
-
-// Split Bucket buckets[hash] and reassign pointers
-// O(N) = O(1)
-template <typename Key, size_t N> void EH_set<Key, N>::split_bucket(size_type hash) noexcept {
-    Bucket* b = buckets[hash];
-    if (b->l >= d) {  // ensure there is enough space to split
-        expansion();
-    }
-    b->arrsz = 0;              // clear Bucket
-    Bucket* b1{new Bucket{}};  // 1 prefix
-    b1->l = ++b->l;            // l increases by 1
-
-    // rehash every Element from original Bucket
-    // only the l+1 least significant bit must be checked, so rbitshift by l and
-    // test if bit is set no temp copy needed, since we always check after newly
-    // added elements
-    for (size_type i{0}; i < N; ++i) {
-        (hasher{}(b->elements[i])) >> (b->l - 1) & 1 ? b1->append(b->elements[i]) : b->append(b->elements[i]);
-    }
-
-    // get first index that should point to new Bucket (first pointer points to
-    // Original, so first pointer + offset points to new)
-    size_type offset{1ULL << (b->l - 1)};
-    size_type first{(hash & (offset - 1)) + offset};  // first Pointer from original Bucket is hash value % offset
-    offset += offset;                                 // double old offset (offset for new buckets)
-
-    // assign every pointer that should point to new Bucket (2 * original
-    // offset)
-    for (; first < nD; first += offset) {
-        buckets[first] = b1;
-    }
-}
+};
 
 /*---------------------------EH_set methods-----------------------------*/
 
-// create empty set (empty set contains 1 Bucket)
-// O(1)
-template <typename Key, size_t N> EH_set<Key, N>::EH_set() noexcept : sz{0}, d{0}, nD{1}, buckets{new Bucket*[nD]} {
-    for (size_t i{0}; i < nD; ++i) {
-        buckets[i] = new Bucket{};
-    }
-}
-
 // calls it Constructor
 // O(list size)
-template <typename Key, size_t N>
-EH_set<Key, N>::EH_set(std::initializer_list<key_type> ilist) noexcept : EH_set{std::begin(ilist), std::end(ilist)} {}
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+EH_set<Key, N, Digest, SplitPolicy, Layout>::EH_set(std::initializer_list<key_type> ilist) noexcept
+    : EH_set{std::begin(ilist), std::end(ilist)} {}
 
 // calls list insert
 // O(it range)
-template <typename Key, size_t N>
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
 template <typename InputIt>
-EH_set<Key, N>::EH_set(InputIt first, InputIt last) noexcept : EH_set{} {
+EH_set<Key, N, Digest, SplitPolicy, Layout>::EH_set(InputIt first, InputIt last) noexcept : EH_set{} {
     insert(first, last);
 }
 
-// copies all elements from other set
-// O(other.nD)
-template <typename Key, size_t N>
-EH_set<Key, N>::EH_set(const EH_set& other) noexcept
-    : sz{other.sz}, d{other.d}, nD{other.nD}, buckets{new Bucket*[nD]} {
-    for (size_t i{0}; i < nD; ++i) {
-        if (other.buckets[i]->high_bit() > i) {
-            buckets[i] = new Bucket{*other.buckets[i]};
-        } else {
-            buckets[i] = buckets[i & (other.buckets[i]->high_bit() - 1)];
-        }
-    }
-}
-
-// Destruktor
-// find out if pointer is last pointer to bucket and delete
-// O(nD)
-template <typename Key, size_t N> EH_set<Key, N>::~EH_set() noexcept {
-    for (size_t i{0}; i < nD; ++i) {
-        if (i >= nD - buckets[i]->high_bit()) {
-            delete buckets[i];
-        }
-    }
-    delete[] buckets;
-}
-
-// clear all values, without losing structure and insert keys
-// O(nD + other.sz)
-template <typename Key, size_t N> EH_set<Key, N>& EH_set<Key, N>::operator=(const EH_set<Key, N>& other) noexcept {
-    for (size_type i{0}; i < nD; ++i) {
-        buckets[i & (nD - 1)]->arrsz = 0;
-    }
-    sz = 0;
-    for (const key_type& key : other) {
-        add(key, false);  // insert without checking the values
-    }
+// copies the directory shape and Buckets of other, reusing the Buckets of this (see EH_core::assign)
+// O(nD + other.nD + other.sz)
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+EH_set<Key, N, Digest, SplitPolicy, Layout>&
+EH_set<Key, N, Digest, SplitPolicy, Layout>::operator=(const EH_set& other) noexcept {
+    core.assign(other.core);
     return *this;
 }
 
 // clears all values, without losing structur and inserts ilist
 // O(nD + list size)
-template <typename Key, size_t N>
-EH_set<Key, N>& EH_set<Key, N>::operator=(std::initializer_list<key_type> ilist) noexcept {
-    for (size_type i{0}; i < nD; ++i) {
-        buckets[i]->arrsz = 0;
-    }
-    sz = 0;
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+EH_set<Key, N, Digest, SplitPolicy, Layout>&
+EH_set<Key, N, Digest, SplitPolicy, Layout>::operator=(std::initializer_list<key_type> ilist) noexcept {
+    core.clear_keys();
     insert(ilist);
     return *this;
 }
 
+// copy of the set that shares every Bucket with it, until one of both modifies a Bucket and clones it.
+// Take it on the thread that modifies the set, the snapshot can then be handed to readers on other threads
+// O(nD)
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+EH_set<Key, N, Digest, SplitPolicy, Layout> EH_set<Key, N, Digest, SplitPolicy, Layout>::snapshot() const noexcept {
+    return EH_set{*this, snapshot_tag{}};
+}
+
 // O(1)
-template <typename Key, size_t N> typename EH_set<Key, N>::size_type EH_set<Key, N>::size() const noexcept {
-    return sz;
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+typename EH_set<Key, N, Digest, SplitPolicy, Layout>::size_type
+EH_set<Key, N, Digest, SplitPolicy, Layout>::size() const noexcept {
+    return core.size();
 }
 // O(1)
-template <typename Key, size_t N> bool EH_set<Key, N>::empty() const noexcept { return (sz == 0); }
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+bool EH_set<Key, N, Digest, SplitPolicy, Layout>::empty() const noexcept { return (core.size() == 0); }
+// global depth, the deepest hash prefix a Bucket covers
+// O(1)
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+typename EH_set<Key, N, Digest, SplitPolicy, Layout>::size_type
+EH_set<Key, N, Digest, SplitPolicy, Layout>::depth() const noexcept {
+    return core.depth();
+}
 
 // insert list: calls iterator insert
 // O(list size)
-template <typename Key, size_t N> void EH_set<Key, N>::insert(std::initializer_list<key_type> ilist) noexcept {
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+void EH_set<Key, N, Digest, SplitPolicy, Layout>::insert(std::initializer_list<key_type> ilist) noexcept {
     if (!ilist.size()) {
         return;
     }
     insert(std::begin(ilist), std::end(ilist));
 }
 
-// calls private method add
+// copies key into the set if it is not inside yet
+// O(1)
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+std::pair<typename EH_set<Key, N, Digest, SplitPolicy, Layout>::iterator, bool>
+EH_set<Key, N, Digest, SplitPolicy, Layout>::insert(const key_type& key) noexcept {
+    return core.add(true, key);
+}
+
+// moves key into the set if it is not inside yet
+// O(1)
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+std::pair<typename EH_set<Key, N, Digest, SplitPolicy, Layout>::iterator, bool>
+EH_set<Key, N, Digest, SplitPolicy, Layout>::insert(key_type&& key) noexcept {
+    return core.add(true, std::move(key));
+}
+
+// constructs the key from args, then moves it into the set
 // O(1)
-template <typename Key, size_t N>
-std::pair<typename EH_set<Key, N>::iterator, bool> EH_set<Key, N>::insert(const key_type& key) noexcept {
-    size_type old_sz{sz};
-    return {add(key), (old_sz != sz)};
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+template <typename... Args>
+std::pair<typename EH_set<Key, N, Digest, SplitPolicy, Layout>::iterator, bool>
+EH_set<Key, N, Digest, SplitPolicy, Layout>::emplace(Args&&... args) noexcept {
+    return insert(key_type(std::forward<Args>(args)...));
 }
 
-// iterator insert calls private method add for every item
+// iterator insert adds every item
+// (moves the keys if the iterator yields rvalues, e.g. std::move_iterator)
 // O(range size)
-template <typename Key, size_t N>
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
 template <typename InputIt>
-void EH_set<Key, N>::insert(InputIt first, InputIt last) noexcept {
+void EH_set<Key, N, Digest, SplitPolicy, Layout>::insert(InputIt first, InputIt last) noexcept {
     for (auto it{first}; it != last; ++it) {
-        add(*it);
+        core.add(true, *it);
     }
 }
 
-// swap with empty set
-// O(nD) (because Destruktor)
-template <typename Key, size_t N> void EH_set<Key, N>::clear() noexcept {
-    EH_set temp{};
-    swap(temp);
+// batched insert of keys[0..n), prefetches the Buckets of a group of keys before inserting them
+// O(n)
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+void EH_set<Key, N, Digest, SplitPolicy, Layout>::insert_batch(const key_type* keys, size_type n) noexcept {
+    core.add_batch(keys, n);
 }
 
-// hash and call Bucket remove
-// O(1)
-template <typename Key, size_t N>
-typename EH_set<Key, N>::size_type EH_set<Key, N>::erase(const key_type& key) noexcept {
-    if (buckets[hasher{}(key) & (nD - 1)]->remove(key)) {
-        --sz;
-        return 1;
+// splits Buckets ahead of time, so n keys fit in without further splits (on average)
+// O(n / N)
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+void EH_set<Key, N, Digest, SplitPolicy, Layout>::reserve(size_type n) noexcept {
+    core.reserve(n);
+}
+
+// inserts every key of other, both directories are walked in lockstep (see EH_core::merge)
+// O(other.nD + other.sz)
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+void EH_set<Key, N, Digest, SplitPolicy, Layout>::merge(const EH_set& other) noexcept {
+    if (this != &other) {
+        core.merge(other.core);
     }
-    return 0;
 }
 
-// hash and call Bucket find
+// swap with empty set
+// O(nD) (because Destruktor)
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+void EH_set<Key, N, Digest, SplitPolicy, Layout>::clear() noexcept { core.clear(); }
+
 // O(1)
-template <typename Key, size_t N>
-typename EH_set<Key, N>::size_type EH_set<Key, N>::count(const key_type& key) const noexcept {
-    return buckets[hasher{}(key) & (nD - 1)]->find(key) != N;
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+typename EH_set<Key, N, Digest, SplitPolicy, Layout>::size_type
+EH_set<Key, N, Digest, SplitPolicy, Layout>::erase(const key_type& key) noexcept {
+    return core.erase(key);
 }
 
-// hash and call Bucket find
 // O(1)
-template <typename Key, size_t N>
-typename EH_set<Key, N>::iterator EH_set<Key, N>::find(const key_type& key) const noexcept {
-    size_type idx = buckets[hasher{}(key) & (nD - 1)]->find(key);
-    return idx != N ? iterator(idx, hasher{}(key) & (nD - 1), this) : end();
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+typename EH_set<Key, N, Digest, SplitPolicy, Layout>::size_type
+EH_set<Key, N, Digest, SplitPolicy, Layout>::count(const key_type& key) const noexcept {
+    return core.count(key);
 }
 
-// just uses std::swap for every instance variable
 // O(1)
-template <typename Key, size_t N> void EH_set<Key, N>::swap(EH_set& other) noexcept {
-    using std::swap;
-    swap(d, other.d);
-    swap(nD, other.nD);
-    swap(sz, other.sz);
-    swap(buckets, other.buckets);
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+typename EH_set<Key, N, Digest, SplitPolicy, Layout>::iterator
+EH_set<Key, N, Digest, SplitPolicy, Layout>::find(const key_type& key) const noexcept {
+    return core.find(key);
+}
+
+// batched count: out[i] is set if keys[i] is in the set
+// O(n)
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+void
+EH_set<Key, N, Digest, SplitPolicy, Layout>::count_batch(const key_type* keys, size_type n, bool* out) const noexcept {
+    core.count_batch(keys, n, out);
+}
+
+// batched find: out[i] is the iterator to keys[i], or end() if not found
+// O(n)
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+void EH_set<Key, N, Digest, SplitPolicy, Layout>::find_batch(const key_type* keys, size_type n,
+                                                             iterator* out) const noexcept {
+    core.find_batch(keys, n, out);
+}
+
+// checksum of the keys whose hash ends in the bits least significant bits of prefix, the whole set by default
+// (only with Digest). To find where two copies of a set differ, compare the checksums of prefix and
+// prefix + 2^bits at bits + 1 wherever the checksums at bits differ, starting at 0. Once bits reaches
+// depth() of the sending side, each differing region lies within one of its Buckets and is sent with for_each
+// O(1) for the whole set, see EH_core::digest otherwise
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+typename EH_set<Key, N, Digest, SplitPolicy, Layout>::size_type
+EH_set<Key, N, Digest, SplitPolicy, Layout>::digest(size_type prefix, size_type bits) const noexcept {
+    return core.digest(prefix, bits);
 }
 
+// calls f(key) for every key whose hash ends in the bits least significant bits of prefix
+// O(N + nD / 2^bits + keys in the region)
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+template <typename F>
+void EH_set<Key, N, Digest, SplitPolicy, Layout>::for_each(size_type prefix, size_type bits, F f) const noexcept {
+    core.for_each(prefix, bits, [&f](const slots_type& slots, size_type i) { f(slots.key(i)); });
+}
+
+// O(1)
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+void EH_set<Key, N, Digest, SplitPolicy, Layout>::swap(EH_set& other) noexcept { core.swap(other.core); }
+
 // begin-iterator is first element of first Bucket
 // O(1)
-template <typename Key, size_t N> typename EH_set<Key, N>::const_iterator EH_set<Key, N>::begin() const noexcept {
-    return const_iterator(0, 0, this);
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+typename EH_set<Key, N, Digest, SplitPolicy, Layout>::const_iterator
+EH_set<Key, N, Digest, SplitPolicy, Layout>::begin() const noexcept {
+    return core.begin();
 }
 // end-iterator is first element of (nonexistent) nDth Bucket
 // O(1)
-template <typename Key, size_t N> typename EH_set<Key, N>::const_iterator EH_set<Key, N>::end() const noexcept {
-    return const_iterator(this);
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+typename EH_set<Key, N, Digest, SplitPolicy, Layout>::const_iterator
+EH_set<Key, N, Digest, SplitPolicy, Layout>::end() const noexcept {
+    return core.end();
 }
 
 // Outputs entire set to ostream
-template <typename Key, size_t N> void EH_set<Key, N>::dump(std::ostream& o) const noexcept {
-    o << "Extendible Hashing <" << typeid(Key).name() << ',' << N << ">, d = " << d << ", nD = " << nD
-      << ", sz = " << sz << '\n';
-    // printing...
-    for (size_type i{0}; i < nD; ++i) {
-        Bucket* b = buckets[i];
-        size_type orig_bucket = i & (buckets[i]->high_bit() - 1);
-        o << i;
-        if (orig_bucket != i) {
-            o << " ~~> " << orig_bucket;  // if pointer isnt first to a bucket show reference to first Bucket
-        }
-        o << " --> [l = ";
-        o << b->l << ", offset = " << (1 << b->l) << ", arrsz = " << b->arrsz << " | ";
-        for (size_type j{0}; j < b->arrsz; ++j) {
-            o << b->elements[j] << ' ';
-        }
-        o << "]\n";
-    }
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+void EH_set<Key, N, Digest, SplitPolicy, Layout>::dump(std::ostream& o) const noexcept {
+    o << "Extendible Hashing <" << typeid(Key).name() << ',' << N << ">, d = " << core.depth()
+      << ", nD = " << core.directory_size() << ", sz = " << core.size() << '\n';
+    core.dump(o, [](std::ostream& o, const slots_type& slots, size_type i) { o << slots.key(i); });
 }
 
-/*---------------------------Iterator Class-------------------------------*/
-
-template <typename Key, size_t N> class EH_set<Key, N>::Iterator {
-  public:
-    using value_type = Key;
-    using difference_type = std::ptrdiff_t;
-    using reference = const value_type&;
-    using pointer = const value_type*;
-    using iterator_category = std::forward_iterator_tag;
-
-  private:
-    size_type idx{0};
-    const EH_set* set{nullptr};
-    size_type b{0};
-
-    // skip to the next, first ptr, that is the first occurence, to point to a
-    // non-empty Bucket
-    void skip() noexcept {
-        while (b >= set->buckets[b]->high_bit() || set->buckets[b]->arrsz == 0) {
-            b++;
-            if (is_end()) {  // if we are at the end ptr, dont increase anymore
-                break;
-            }
-        }
-    }
-
-    // is iterator at the end?
-    [[nodiscard]] bool is_end() const noexcept { return b == set->nD; }
-
-    // returns a pointer to the current element
-    [[nodiscard]] pointer ptr() const noexcept { return &set->buckets[b]->elements[idx]; }
-
-  public:
-    explicit Iterator(size_type idx, size_type b, const EH_set* set) noexcept
-        : idx{idx}, set{set}, b{b & (set->buckets[b]->high_bit() - 1)} {
-        skip();
-    }
-
-    Iterator(const EH_set* set) noexcept : idx{0}, set{set}, b{set->nD} {}  // for end-iterator
-    Iterator() noexcept : idx{0}, set{nullptr}, b{0} {}
-
-    [[nodiscard]] reference operator*() const noexcept { return *ptr(); }
-    [[nodiscard]] pointer operator->() const noexcept { return ptr(); }
-
-    Iterator& operator++() noexcept {
-        if (++idx < set->buckets[b]->arrsz) {
-            return *this;
-        }
+// header of the binary format of save and load
+inline constexpr char EH_save_magic[4]{'E', 'H', 'S', '1'};
+
+// writes the set in a compact binary format, in host byte order (Key has to be trivially copyable):
+//   "EHS1", uint8 sizeof(Key), uint32 N, uint8 global depth
+//   per unique Bucket, in the order of its first directory slot: uint8 local depth, uint32 size, the keys
+// returns false if o failed
+// O(nD + sz)
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+bool EH_set<Key, N, Digest, SplitPolicy, Layout>::save(std::ostream& o) const noexcept {
+    static_assert(std::is_trivially_copyable_v<Key>, "save writes the raw bytes of the keys");
+    auto put = [&o](const auto& value) { o.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+
+    o.write(EH_save_magic, sizeof(EH_save_magic));
+    put(static_cast<uint8_t>(sizeof(Key)));
+    put(static_cast<uint32_t>(N));
+    put(static_cast<uint8_t>(core.depth()));
+    core.visit_buckets([&](size_type l, size_type arrsz, const slots_type& slots) {
+        put(static_cast<uint8_t>(l));
+        put(static_cast<uint32_t>(arrsz));
+        o.write(reinterpret_cast<const char*>(slots.keys()), static_cast<std::streamsize>(arrsz * sizeof(Key)));
+    });
+    return o.good();
+}
 
-        // if we are at the end of current bucket
-        idx = 0;
-        ++b;
-        if (b != set->nD) {  // if we are at the end ptr, dont skip to next valid ptr
-            skip();
-        }
-        return *this;
-    }
+// restores a set written by save, with the same directory shape and without rehashing
+// returns false and leaves the set unchanged if in does not hold a valid set of this Key size and N
+// O(nD + sz)
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+bool EH_set<Key, N, Digest, SplitPolicy, Layout>::load(std::istream& in) noexcept {
+    static_assert(std::is_trivially_copyable_v<Key>, "load reads the raw bytes of the keys");
+    auto get = [&in](auto& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    };
 
-    Iterator operator++(int) noexcept {
-        auto temp{*this};
-        ++(*this);
-        return temp;
+    char magic[sizeof(EH_save_magic)]{};
+    uint8_t key_size{0};
+    uint32_t n{0};
+    uint8_t depth{0};
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), EH_save_magic) ||
+        !get(key_size) || key_size != sizeof(Key) || !get(n) || n != N || !get(depth) ||
+        depth >= std::numeric_limits<size_type>::digits) {
+        return false;
     }
-
-    // returns current position of iterator in format {Bucket number, Index in
-    // Bucker}, for debugging
-    std::pair<unsigned, unsigned> get_pos() const noexcept { return {b, idx}; }
-
-    [[nodiscard]] friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
-        if (lhs.is_end() || rhs.is_end()) {  // if one of the iterators is the end iterator, test if both are
-            return lhs.is_end() && rhs.is_end();
+    return core.rebuild(depth, [&](size_type& l, size_type& arrsz, slots_type& slots) {
+        uint8_t local{0};
+        uint32_t count{0};
+        if (!get(local) || !get(count) || count > slots_type::capacity ||
+            !in.read(reinterpret_cast<char*>(slots.storage), static_cast<std::streamsize>(count * sizeof(Key)))) {
+            return false;
         }
-        return (lhs.ptr() == rhs.ptr());  // test if they point to the same element
-    }
-    [[nodiscard]] friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept { return !(lhs == rhs); }
-};
+        slots.restore(count);
+        l = local;
+        arrsz = count;
+        return true;
+    });
+}
 
-template <typename Key, size_t N> void swap(EH_set<Key, N>& lhs, EH_set<Key, N>& rhs) noexcept { lhs.swap(rhs); }
+template <typename Key, size_t N, bool Digest, typename SplitPolicy, typename Layout>
+void swap(EH_set<Key, N, Digest, SplitPolicy, Layout>& lhs, EH_set<Key, N, Digest, SplitPolicy, Layout>& rhs) noexcept {
+    lhs.swap(rhs);
+}
 
 #endif  // EH_SET_H
@@ -0,0 +1,482 @@
+#ifndef EH_SHARED_SET_H
+#define EH_SHARED_SET_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <functional>
+#include <iostream>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <typeinfo>
+#include <unistd.h>
+#include <utility>
+
+// Extendible Hashing Set in a POSIX shared memory segment, so processes on one host share a single copy.
+// Same layout as EH_compact_set (32-bit Bucket indices in the directory, all Buckets in one array), but
+// header, directory and Buckets sit at fixed offsets in the segment. No pointer is stored, so every process
+// may map the segment at a different address.
+// The segment is sized for a capacity when it is created and never grows. Directory and Buckets are
+// reserved for that capacity, but pages are only backed by memory once they are touched.
+// Every access takes a process shared reader-writer lock from the header: lookups of many processes run
+// concurrently, insert, erase and clear run exclusively. The lock prefers writers, so a writer waits only for
+// the lookups already running, not for a stream of readers that keeps overlapping. A process that dies while
+// holding the lock blocks all others, a lock that can't be taken at all terminates.
+// All processes have to use the same Key, N and hasher (i.e. the same build).
+template <typename Key, size_t N = 16> class EH_shared_set {
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_default_constructible_v<Key>,
+                  "EH_shared_set needs trivial keys");
+    static_assert(N > 0 && N <= UINT32_MAX, "Bucket size out of range");
+
+  public:
+    using value_type = Key;
+    using key_type = Key;
+    using size_type = size_t;
+    using key_equal = std::equal_to<key_type>;
+    using hasher = std::hash<key_type>;
+
+  private:
+    using index_type = std::uint32_t;  // Bucket index in directory
+    using count_type =
+        std::conditional_t<(N <= UINT8_MAX), std::uint8_t,
+                           std::conditional_t<(N <= UINT16_MAX), std::uint16_t, std::uint32_t>>;
+
+    struct Bucket {
+        key_type elements[N];
+        std::uint8_t l;    // local depth
+        count_type arrsz;  // number of elems in Bucket
+
+        [[nodiscard]] size_type find(const key_type& elem) const noexcept;
+        [[nodiscard]] size_type high_bit() const noexcept { return size_type{1} << l; }
+    };
+
+    // "EHSHM01" read as a little endian integer
+    static constexpr std::uint64_t magic{0x0031304d48534845};
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "the magic is published to other processes");
+
+    // start of the segment, everything else is found by offsets from here
+    struct Header {
+        std::atomic<std::uint64_t> magic;  // stored last by create, so open never sees a half written header
+        std::uint32_t key_size;
+        std::uint32_t n;
+        std::uint32_t max_depth;  // directory is reserved for 2^max_depth indices
+        index_type cap;           // number of Buckets reserved
+        size_type dir_offset;
+        size_type pool_offset;
+        size_type bytes;  // segment size
+        pthread_rwlock_t lock;
+        size_type sz;   // actual size
+        size_type d;    // global depth
+        index_type nB;  // number of Buckets in use
+    };
+
+    // locks hdr->lock for the lifetime of the guard, terminates if locking or unlocking fails (e.g. too many
+    // readers, or a thread that already holds the lock), since the set can't be accessed safely then
+    class Guard {
+        pthread_rwlock_t* lock;
+
+      public:
+        Guard(pthread_rwlock_t* lock, bool exclusive) noexcept : lock{lock} {
+            if ((exclusive ? pthread_rwlock_wrlock(lock) : pthread_rwlock_rdlock(lock)) != 0) {
+                std::terminate();
+            }
+        }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        ~Guard() {
+            if (pthread_rwlock_unlock(lock) != 0) {
+                std::terminate();
+            }
+        }
+    };
+
+    Header* hdr;  // mapping of the segment, nullptr if not attached
+
+    explicit EH_shared_set(Header* hdr) noexcept : hdr{hdr} {}
+
+    [[nodiscard]] index_type* dir() const noexcept {
+        return reinterpret_cast<index_type*>(reinterpret_cast<char*>(hdr) + hdr->dir_offset);
+    }
+    [[nodiscard]] Bucket* pool() const noexcept {
+        return reinterpret_cast<Bucket*>(reinterpret_cast<char*>(hdr) + hdr->pool_offset);
+    }
+    [[nodiscard]] size_type nD() const noexcept { return size_type{1} << hdr->d; }
+    [[nodiscard]] Bucket& bucket(size_type i) const noexcept { return pool()[dir()[i]]; }
+
+    bool split_bucket(size_type hash) noexcept;
+    static Header* map(int fd, size_type bytes) noexcept;
+    static bool init_lock(pthread_rwlock_t* lock) noexcept;
+
+  public:
+    EH_shared_set() noexcept;
+    EH_shared_set(const EH_shared_set&) = delete;
+    EH_shared_set(EH_shared_set&& other) noexcept;
+
+    ~EH_shared_set() noexcept;
+
+    EH_shared_set& operator=(const EH_shared_set&) = delete;
+    EH_shared_set& operator=(EH_shared_set&& other) noexcept;
+
+    static EH_shared_set create(const char* name, size_type capacity) noexcept;
+    static EH_shared_set open(const char* name) noexcept;
+    static bool remove(const char* name) noexcept;
+
+    [[nodiscard]] bool attached() const noexcept;
+    [[nodiscard]] size_type size() const noexcept;
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_type depth() const noexcept;
+    [[nodiscard]] size_type bucket_capacity() const noexcept;
+
+    bool insert(const key_type& key) noexcept;
+    size_type erase(const key_type& key) noexcept;
+    void clear() noexcept;
+
+    [[nodiscard]] size_type count(const key_type& key) const noexcept;
+    void count_batch(const key_type* keys, size_type n, bool* out) const noexcept;
+    template <typename F> void for_each(F f) const noexcept;
+
+    void swap(EH_shared_set& other) noexcept;
+
+    void dump(std::ostream& o = std::cerr) const noexcept;
+};
+
+/*--------------------------Bucket methods----------------------------*/
+
+// find Element in Bucket
+// returns index of Element in Bucket, if found, and N otherwise
+// O(N) = O(1)
+template <typename Key, size_t N>
+typename EH_shared_set<Key, N>::size_type EH_shared_set<Key, N>::Bucket::find(const key_type& elem) const noexcept {
+    for (size_type i{0}; i < arrsz; ++i) {
+        if (key_equal{}(elem, elements[i])) {
+            return i;
+        }
+    }
+    return N;
+}
+
+/*------------------------private methods---------------------*/
+
+// Split Bucket at dir[hash] and reassign indices, like EH_compact_set::split_bucket, but the directory and
+// the Buckets can't grow beyond the reservation
+// returns false (and changes nothing) if the segment is out of space
+// O(N) (+ O(nD) for expansion)
+template <typename Key, size_t N> bool EH_shared_set<Key, N>::split_bucket(size_type hash) noexcept {
+    Bucket& b = bucket(hash);
+    if (hdr->nB == hdr->cap || (b.l >= hdr->d && hdr->d == hdr->max_depth)) {
+        return false;
+    }
+    if (b.l >= hdr->d) {  // expansion, the reservation already holds the upper half
+        std::memcpy(dir() + nD(), dir(), nD() * sizeof(index_type));
+        ++hdr->d;
+    }
+    index_type other{hdr->nB++};
+    Bucket& b1 = pool()[other];  // 1 prefix
+    b1.arrsz = 0;
+    b1.l = ++b.l;
+
+    // rehash every Element from original Bucket, compacting the ones that stay
+    count_type n{b.arrsz};
+    b.arrsz = 0;
+    for (size_type i{0}; i < n; ++i) {
+        Bucket& to = (hasher{}(b.elements[i]) >> (b.l - 1) & 1) ? b1 : b;
+        to.elements[to.arrsz++] = b.elements[i];
+    }
+
+    // assign every index that should point to new Bucket (see EH_set::split_bucket)
+    size_type offset{size_type{1} << (b.l - 1)};
+    size_type first{(hash & (offset - 1)) + offset};
+    offset += offset;
+    for (; first < nD(); first += offset) {
+        dir()[first] = other;
+    }
+    return true;
+}
+
+// maps bytes of fd shared, returns nullptr on failure
+template <typename Key, size_t N>
+typename EH_shared_set<Key, N>::Header* EH_shared_set<Key, N>::map(int fd, size_type bytes) noexcept {
+    void* p{::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+    return p == MAP_FAILED ? nullptr : static_cast<Header*>(p);
+}
+
+// initializes the process shared, writer preferring lock of a new segment
+// returns false if any step fails
+// O(1)
+template <typename Key, size_t N> bool EH_shared_set<Key, N>::init_lock(pthread_rwlock_t* lock) noexcept {
+    pthread_rwlockattr_t attr;
+    if (pthread_rwlockattr_init(&attr) != 0) {
+        return false;
+    }
+    // glibc prefers readers by default, back to back lookups of many processes would starve the writer.
+    // Writer preference needs the lock to be non recursive, no method takes it twice
+    bool ok{pthread_rwlockattr_setpshared(&attr, PTHREAD_PROCESS_SHARED) == 0 &&
+            pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP) == 0 &&
+            pthread_rwlock_init(lock, &attr) == 0};
+    pthread_rwlockattr_destroy(&attr);
+    return ok;
+}
+
+/*---------------------------EH_shared_set methods-----------------------------*/
+
+// a set that is not attached to a segment, only assignment, swap and attached may be used
+// O(1)
+template <typename Key, size_t N> EH_shared_set<Key, N>::EH_shared_set() noexcept : hdr{nullptr} {}
+
+// takes over the mapping
+// O(1)
+template <typename Key, size_t N>
+EH_shared_set<Key, N>::EH_shared_set(EH_shared_set&& other) noexcept : hdr{std::exchange(other.hdr, nullptr)} {}
+
+// unmaps the segment, it stays alive until remove is called
+// O(1)
+template <typename Key, size_t N> EH_shared_set<Key, N>::~EH_shared_set() noexcept {
+    if (hdr) {
+        ::munmap(hdr, hdr->bytes);
+    }
+}
+
+// O(1)
+template <typename Key, size_t N>
+EH_shared_set<Key, N>& EH_shared_set<Key, N>::operator=(EH_shared_set&& other) noexcept {
+    EH_shared_set temp{std::move(other)};
+    swap(temp);
+    return *this;
+}
+
+// creates the segment name (e.g. "/my_set", see shm_open) and attaches to it. Reserves 2 * (capacity / N + 1)
+// Buckets, twice what capacity keys need when every Bucket is full, because a split leaves two half full
+// Buckets. The directory is reserved up to 16 times that many entries. Keys that spread about evenly fit,
+// skewed hashes may run out of Buckets or directory earlier, insert returns false then
+// fails if name already exists: truncating a segment that other processes have mapped makes their next
+// access SIGBUS, so an old segment has to be removed first
+// returns a set that is not attached on failure
+// O(1), the reservation is not touched
+template <typename Key, size_t N>
+EH_shared_set<Key, N> EH_shared_set<Key, N>::create(const char* name, size_type capacity) noexcept {
+    size_type buckets{2 * (capacity / N + 1)};
+    if (buckets >= UINT32_MAX) {
+        return EH_shared_set{};
+    }
+    std::uint32_t max_depth{0};
+    while ((size_type{1} << max_depth) < buckets) {
+        ++max_depth;
+    }
+    max_depth = std::min<std::uint32_t>(max_depth + 4, 32);  // room for uneven splits
+
+    size_type dir_offset{(sizeof(Header) + alignof(Bucket) - 1) / alignof(Bucket) * alignof(Bucket)};
+    size_type dir_bytes{(size_type{1} << max_depth) * sizeof(index_type)};
+    size_type pool_offset{(dir_offset + dir_bytes + alignof(Bucket) - 1) / alignof(Bucket) * alignof(Bucket)};
+    size_type bytes{pool_offset + buckets * sizeof(Bucket)};
+
+    int fd{::shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600)};
+    if (fd < 0) {
+        return EH_shared_set{};
+    }
+    Header* h{::ftruncate(fd, static_cast<off_t>(bytes)) == 0 ? map(fd, bytes) : nullptr};
+    ::close(fd);
+    if (!h) {
+        ::shm_unlink(name);
+        return EH_shared_set{};
+    }
+
+    h->key_size = sizeof(Key);
+    h->n = N;
+    h->max_depth = max_depth;
+    h->cap = static_cast<index_type>(buckets);
+    h->dir_offset = dir_offset;
+    h->pool_offset = pool_offset;
+    h->bytes = bytes;
+    if (!init_lock(&h->lock)) {
+        ::munmap(h, bytes);
+        ::shm_unlink(name);
+        return EH_shared_set{};
+    }
+    h->sz = 0;
+    h->d = 0;
+    h->nB = 1;
+
+    EH_shared_set set{h};
+    set.dir()[0] = 0;
+    set.pool()[0].l = 0;
+    set.pool()[0].arrsz = 0;
+    h->magic.store(magic, std::memory_order_release);  // last, open rejects a segment without it
+    return set;
+}
+
+// attaches to the segment name created by create (with the same Key and N)
+// returns a set that is not attached on failure
+// O(1)
+template <typename Key, size_t N> EH_shared_set<Key, N> EH_shared_set<Key, N>::open(const char* name) noexcept {
+    int fd{::shm_open(name, O_RDWR, 0)};
+    if (fd < 0) {
+        return EH_shared_set{};
+    }
+    struct stat st{};
+    Header* h{nullptr};
+    if (::fstat(fd, &st) == 0 && static_cast<size_type>(st.st_size) >= sizeof(Header)) {
+        h = map(fd, static_cast<size_type>(st.st_size));
+    }
+    ::close(fd);
+    if (h && (h->magic.load(std::memory_order_acquire) != magic || h->key_size != sizeof(Key) || h->n != N ||
+              h->bytes != static_cast<size_type>(st.st_size))) {
+        ::munmap(h, static_cast<size_type>(st.st_size));
+        h = nullptr;
+    }
+    return EH_shared_set{h};
+}
+
+// removes the segment name, attached sets keep working until they are destroyed
+// O(1)
+template <typename Key, size_t N> bool EH_shared_set<Key, N>::remove(const char* name) noexcept {
+    return ::shm_unlink(name) == 0;
+}
+
+// O(1)
+template <typename Key, size_t N> bool EH_shared_set<Key, N>::attached() const noexcept { return hdr != nullptr; }
+
+// O(1)
+template <typename Key, size_t N>
+typename EH_shared_set<Key, N>::size_type EH_shared_set<Key, N>::size() const noexcept {
+    Guard guard{&hdr->lock, false};
+    return hdr->sz;
+}
+
+// O(1)
+template <typename Key, size_t N> bool EH_shared_set<Key, N>::empty() const noexcept { return size() == 0; }
+
+// O(1)
+template <typename Key, size_t N>
+typename EH_shared_set<Key, N>::size_type EH_shared_set<Key, N>::depth() const noexcept {
+    Guard guard{&hdr->lock, false};
+    return hdr->d;
+}
+
+// number of Buckets the segment has room for
+// O(1)
+template <typename Key, size_t N>
+typename EH_shared_set<Key, N>::size_type EH_shared_set<Key, N>::bucket_capacity() const noexcept {
+    return hdr->cap;
+}
+
+// inserts key, splitting like EH_compact_set::add
+// returns true if key is in the set afterwards, false if the segment is out of space
+// O(1)
+template <typename Key, size_t N> bool EH_shared_set<Key, N>::insert(const key_type& key) noexcept {
+    Guard guard{&hdr->lock, true};
+    size_type hash{hasher{}(key) & (nD() - 1)};
+    if (bucket(hash).find(key) != N) {
+        return true;
+    }
+    while (bucket(hash).arrsz == N) {  // bucket overflow, split (and expansion) necessary
+        if (!split_bucket(hash)) {
+            return false;
+        }
+        hash = hasher{}(key) & (nD() - 1);
+    }
+    Bucket& b = bucket(hash);
+    b.elements[b.arrsz++] = key;
+    ++hdr->sz;
+    return true;
+}
+
+// overwrite with last element of the Bucket
+// O(1)
+template <typename Key, size_t N>
+typename EH_shared_set<Key, N>::size_type EH_shared_set<Key, N>::erase(const key_type& key) noexcept {
+    Guard guard{&hdr->lock, true};
+    Bucket& b = bucket(hasher{}(key) & (nD() - 1));
+    size_type i{b.find(key)};
+    if (i == N) {
+        return 0;
+    }
+    b.elements[i] = b.elements[--b.arrsz];
+    --hdr->sz;
+    return 1;
+}
+
+// back to a single empty Bucket, the reservation stays
+// O(1)
+template <typename Key, size_t N> void EH_shared_set<Key, N>::clear() noexcept {
+    Guard guard{&hdr->lock, true};
+    hdr->sz = 0;
+    hdr->d = 0;
+    hdr->nB = 1;
+    dir()[0] = 0;
+    pool()[0].l = 0;
+    pool()[0].arrsz = 0;
+}
+
+// hash and call Bucket find
+// O(1)
+template <typename Key, size_t N>
+typename EH_shared_set<Key, N>::size_type EH_shared_set<Key, N>::count(const key_type& key) const noexcept {
+    Guard guard{&hdr->lock, false};
+    return bucket(hasher{}(key) & (nD() - 1)).find(key) != N;
+}
+
+// out[i] = count(keys[i]), taking the lock once
+// O(n)
+template <typename Key, size_t N>
+void EH_shared_set<Key, N>::count_batch(const key_type* keys, size_type n, bool* out) const noexcept {
+    Guard guard{&hdr->lock, false};
+    size_type mask{nD() - 1};
+    for (size_type i{0}; i < n; ++i) {
+        out[i] = bucket(hasher{}(keys[i]) & mask).find(keys[i]) != N;
+    }
+}
+
+// calls f(key) for every key while holding the lock shared, f must not use the set (a waiting writer would
+// block a nested lookup forever)
+// O(nD + sz)
+template <typename Key, size_t N>
+template <typename F>
+void EH_shared_set<Key, N>::for_each(F f) const noexcept {
+    Guard guard{&hdr->lock, false};
+    for (size_type i{0}; i < nD(); ++i) {
+        const Bucket& b = bucket(i);
+        if (b.high_bit() > i) {
+            for (size_type j{0}; j < b.arrsz; ++j) {
+                f(b.elements[j]);
+            }
+        }
+    }
+}
+
+// swaps the mappings
+// O(1)
+template <typename Key, size_t N> void EH_shared_set<Key, N>::swap(EH_shared_set& other) noexcept {
+    std::swap(hdr, other.hdr);
+}
+
+// Outputs entire set to ostream, same format as EH_compact_set::dump
+template <typename Key, size_t N> void EH_shared_set<Key, N>::dump(std::ostream& o) const noexcept {
+    Guard guard{&hdr->lock, false};
+    o << "Extendible Hashing (shared) <" << typeid(Key).name() << ',' << N << ">, d = " << hdr->d
+      << ", nD = " << nD() << ", sz = " << hdr->sz << ", nB = " << hdr->nB << ", cap = " << hdr->cap << '\n';
+    for (size_type i{0}; i < nD(); ++i) {
+        const Bucket& b = bucket(i);
+        size_type orig_bucket = i & (b.high_bit() - 1);
+        o << i;
+        if (orig_bucket != i) {
+            o << " ~~> " << orig_bucket;
+        }
+        o << " --> [l = " << +b.l << ", offset = " << b.high_bit() << ", arrsz = " << +b.arrsz << " | ";
+        for (size_type j{0}; j < b.arrsz; ++j) {
+            o << b.elements[j] << ' ';
+        }
+        o << "]\n";
+    }
+}
+
+template <typename Key, size_t N> void swap(EH_shared_set<Key, N>& lhs, EH_shared_set<Key, N>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+#endif  // EH_SHARED_SET_H
@@ -0,0 +1,550 @@
+#ifndef EH_STRING_SET_H
+#define EH_STRING_SET_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <string_view>
+
+// Extendible Hashing Set of strings.
+// Instead of std::string objects every Bucket keeps the bytes of its keys in one
+// arena and a slot array of fingerprint, offset and length per key. Probing a
+// Bucket compares the dense fingerprint bytes first and only touches the arena
+// on a fingerprint match, so a lookup reads at most two contiguous regions.
+// Splitting copies bytes between arenas, no strings are constructed.
+// Keys are handed out as std::string_view into the arena.
+template <size_t N = 16> class EH_string_set {
+    static_assert(N > 0, "Bucket size out of range");
+
+  public:
+    class Iterator;
+    using value_type = std::string_view;
+    using key_type = std::string_view;
+    using reference = std::string_view;
+    using const_reference = std::string_view;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using const_iterator = Iterator;
+    using iterator = const_iterator;
+    using key_equal = std::equal_to<key_type>;
+    using hasher = std::hash<key_type>;
+
+  private:
+    struct Bucket {
+        std::uint8_t fps[N];    // fingerprints (highest byte of hash)
+        std::uint32_t offs[N];  // offset of key in arena
+        std::uint32_t lens[N];  // length of key
+        size_type l{0};         // local depth
+        size_type arrsz{0};     // number of elems in Bucket
+        char* arena{nullptr};   // key bytes
+        std::uint32_t used{0};  // bytes used in arena, including removed keys
+        std::uint32_t live{0};  // bytes of keys still in Bucket
+        std::uint32_t capacity{0};
+
+        Bucket() noexcept = default;
+        Bucket(const Bucket& other) noexcept;
+        Bucket& operator=(const Bucket&) = delete;
+        ~Bucket() noexcept { std::free(arena); }
+
+        size_type append(key_type elem, std::uint8_t fp) noexcept;
+        size_type remove(key_type elem, std::uint8_t fp) noexcept;
+        [[nodiscard]] size_type find(key_type elem, std::uint8_t fp) const noexcept;
+        [[nodiscard]] key_type key(size_type i) const noexcept { return {arena + offs[i], lens[i]}; }
+        [[nodiscard]] inline size_type high_bit() const noexcept;
+        void reserve(size_type bytes) noexcept;
+    };
+
+    size_type sz;  // actual size
+    size_type d;   // global depth
+    size_type nD;  // 2^d
+    Bucket** buckets;
+
+    [[nodiscard]] static std::uint8_t fingerprint(size_type h) noexcept { return h >> (8 * sizeof(size_type) - 8); }
+
+    void expansion() noexcept;
+    void split_bucket(size_type hash) noexcept;
+    iterator add(key_type k, bool check = true) noexcept;
+
+  public:
+    EH_string_set() noexcept;
+    EH_string_set(std::initializer_list<key_type> ilist) noexcept;
+    template <typename InputIt> EH_string_set(InputIt first, InputIt last) noexcept;
+    EH_string_set(const EH_string_set& other) noexcept;
+
+    ~EH_string_set() noexcept;
+
+    EH_string_set& operator=(const EH_string_set& other) noexcept;
+    EH_string_set& operator=(std::initializer_list<key_type> ilist) noexcept;
+
+    [[nodiscard]] size_type size() const noexcept;
+    [[nodiscard]] bool empty() const noexcept;
+
+    void insert(std::initializer_list<key_type> ilist) noexcept;
+    std::pair<iterator, bool> insert(key_type key) noexcept;
+    template <typename InputIt> void insert(InputIt first, InputIt last) noexcept;
+
+    void clear() noexcept;
+
+    size_type erase(key_type key) noexcept;
+    [[nodiscard]] size_type count(key_type key) const noexcept;
+    [[nodiscard]] iterator find(key_type key) const noexcept;
+
+    void swap(EH_string_set& other) noexcept;
+
+    [[nodiscard]] const_iterator begin() const noexcept;
+    [[nodiscard]] const_iterator end() const noexcept;
+
+    void dump(std::ostream& o = std::cerr) const noexcept;
+
+    // goes through every key in lhs once and calls count for rhs
+    // O(lhs.sz)
+    [[nodiscard]] friend bool operator==(const EH_string_set& lhs, const EH_string_set& rhs) noexcept {
+        if (lhs.sz != rhs.sz) {
+            return false;
+        }
+        for (key_type key : rhs) {
+            if (!lhs.count(key)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+    [[nodiscard]] friend bool operator!=(const EH_string_set& lhs, const EH_string_set& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+};
+
+/*--------------------------Bucket methods----------------------------*/
+
+// copies slots and only the live bytes of the arena
+// O(N + bytes)
+template <size_t N> EH_string_set<N>::Bucket::Bucket(const Bucket& other) noexcept : l{other.l} {
+    reserve(other.live);
+    for (size_type i{0}; i < other.arrsz; ++i) {
+        append(other.key(i), other.fps[i]);
+    }
+}
+
+// make room for bytes more key bytes in the arena
+// drops the bytes of removed keys and grows the arena (at least doubling) if needed
+// O(bytes in arena)
+template <size_t N> void EH_string_set<N>::Bucket::reserve(size_type bytes) noexcept {
+    if (used + bytes <= capacity) {
+        return;
+    }
+    size_type new_cap{capacity};
+    if (live + bytes > capacity) {
+        new_cap = std::max({size_type{64}, live + bytes, size_type{2} * capacity});
+    }
+    if (new_cap > UINT32_MAX) {
+        std::terminate();  // offsets are 32 bit
+    }
+    char* fresh{static_cast<char*>(std::malloc(new_cap))};
+    if (!fresh) {
+        std::terminate();
+    }
+    // copy remaining keys to the front of the new arena
+    std::uint32_t pos{0};
+    for (size_type i{0}; i < arrsz; ++i) {
+        if (lens[i] != 0) {  // the arena is still null if only empty keys were appended
+            std::memcpy(fresh + pos, arena + offs[i], lens[i]);
+        }
+        offs[i] = pos;
+        pos += lens[i];
+    }
+    std::free(arena);
+    arena = fresh;
+    used = pos;
+    capacity = new_cap;
+}
+
+// Append Element to Bucket
+// returns 1 if Element could be inserted, 0 otherwise
+// O(1) (amortized, arena may grow)
+template <size_t N>
+typename EH_string_set<N>::size_type EH_string_set<N>::Bucket::append(key_type elem, std::uint8_t fp) noexcept {
+    if (arrsz == N) {
+        return 0;
+    }
+    reserve(elem.size());
+    if (!elem.empty()) {
+        std::memcpy(arena + used, elem.data(), elem.size());
+    }
+    fps[arrsz] = fp;
+    offs[arrsz] = used;
+    lens[arrsz] = elem.size();
+    used += elem.size();
+    live += elem.size();
+    ++arrsz;
+    return 1;
+}
+
+// find Element in Bucket, only compares bytes if the fingerprint matches
+// returns index of Element in Bucket, if found, and N otherwise
+// O(N) = O(1)
+template <size_t N>
+typename EH_string_set<N>::size_type EH_string_set<N>::Bucket::find(key_type elem, std::uint8_t fp) const noexcept {
+    for (size_type i{0}; i < arrsz; ++i) {
+        if (fps[i] == fp && key_equal{}(elem, key(i))) {
+            return i;
+        }
+    }
+    return N;
+}
+
+// Remove Element in Bucket
+// move last slot into its place, the key bytes stay in the arena until the next reserve
+// O(N) = O(1)
+template <size_t N>
+typename EH_string_set<N>::size_type EH_string_set<N>::Bucket::remove(key_type elem, std::uint8_t fp) noexcept {
+    size_type i{find(elem, fp)};
+    if (i == N) {
+        return 0;
+    }
+    live -= lens[i];
+    --arrsz;
+    fps[i] = fps[arrsz];
+    offs[i] = offs[arrsz];
+    lens[i] = lens[arrsz];
+    return 1;
+}
+
+// returns highest bit that bucket elems agree on
+template <size_t N> inline typename EH_string_set<N>::size_type EH_string_set<N>::Bucket::high_bit() const noexcept {
+    return size_type{1} << l;
+}
+
+/*------------------------private methods---------------------*/
+
+// May call expansion and split multiple times
+// O(1)
+template <size_t N> typename EH_string_set<N>::iterator EH_string_set<N>::add(key_type k, bool check) noexcept {
+    size_type h{hasher{}(k)};
+    std::uint8_t fp{fingerprint(h)};
+    size_type hash = h & (nD - 1);
+    size_type idx{0};
+    if (check && (idx = buckets[hash]->find(k, fp)) != N) {
+        return iterator(idx, hash, this);  // if already inside, skip
+    }
+
+    while (true) {  // while key can't be inserted
+        if (buckets[hash]->append(k, fp)) {
+            sz++;  // successful insert
+            return iterator(buckets[hash]->arrsz - 1, hash, this);
+        }
+        // bucket overflow, split (and expansion) necessary
+        split_bucket(hash);
+        hash = h & (nD - 1);
+    }
+}
+
+// doubles the pointer array
+// O(nD)
+template <size_t N> void EH_string_set<N>::expansion() noexcept {
+    size_type new_nD = size_type{1} << ++d;
+    Bucket** new_buckets{new Bucket*[new_nD]};
+    for (size_type i{0}; i < nD; ++i) {
+        new_buckets[i] = buckets[i];
+        new_buckets[i + nD] = buckets[i];  // pointer repeat with offset nD
+    }
+    delete[] buckets;
+    buckets = new_buckets;
+    nD = new_nD;
+}
+
+// Split Bucket buckets[hash] and reassign pointers
+// the keys that stay are copied into a fresh arena, the others into the new Bucket
+// O(N + bytes in Bucket)
+template <size_t N> void EH_string_set<N>::split_bucket(size_type hash) noexcept {
+    Bucket* b = buckets[hash];
+    if (b->l >= d) {  // ensure there is enough space to split
+        expansion();
+    }
+    Bucket* b1{new Bucket{}};  // 1 prefix
+    b1->l = ++b->l;
+
+    // take over the old arena, appending to b only ever writes slots that were already read
+    char* old{b->arena};
+    size_type n{b->arrsz};
+    b->arena = nullptr;
+    b->arrsz = b->used = b->live = b->capacity = 0;
+    for (size_type i{0}; i < n; ++i) {
+        key_type k{old + b->offs[i], b->lens[i]};
+        (hasher{}(k)) >> (b->l - 1) & 1 ? b1->append(k, b->fps[i]) : b->append(k, b->fps[i]);
+    }
+    std::free(old);
+
+    // assign every pointer that should point to new Bucket (see EH_set::split_bucket)
+    size_type offset{size_type{1} << (b->l - 1)};
+    size_type first{(hash & (offset - 1)) + offset};
+    offset += offset;
+
+    for (; first < nD; first += offset) {
+        buckets[first] = b1;
+    }
+}
+
+/*---------------------------EH_string_set methods-----------------------------*/
+
+// create empty set (empty set contains 1 Bucket)
+// O(1)
+template <size_t N> EH_string_set<N>::EH_string_set() noexcept : sz{0}, d{0}, nD{1}, buckets{new Bucket*[nD]} {
+    buckets[0] = new Bucket{};
+}
+
+// calls it Constructor
+// O(list size)
+template <size_t N>
+EH_string_set<N>::EH_string_set(std::initializer_list<key_type> ilist) noexcept
+    : EH_string_set{std::begin(ilist), std::end(ilist)} {}
+
+// calls list insert
+// O(it range)
+template <size_t N>
+template <typename InputIt>
+EH_string_set<N>::EH_string_set(InputIt first, InputIt last) noexcept : EH_string_set{} {
+    insert(first, last);
+}
+
+// copies all elements from other set
+// O(other.nD + bytes)
+template <size_t N>
+EH_string_set<N>::EH_string_set(const EH_string_set& other) noexcept
+    : sz{other.sz}, d{other.d}, nD{other.nD}, buckets{new Bucket*[nD]} {
+    for (size_type i{0}; i < nD; ++i) {
+        if (other.buckets[i]->high_bit() > i) {
+            buckets[i] = new Bucket{*other.buckets[i]};
+        } else {
+            buckets[i] = buckets[i & (other.buckets[i]->high_bit() - 1)];
+        }
+    }
+}
+
+// Destruktor
+// find out if pointer is last pointer to bucket and delete
+// O(nD)
+template <size_t N> EH_string_set<N>::~EH_string_set() noexcept {
+    for (size_type i{0}; i < nD; ++i) {
+        if (i >= nD - buckets[i]->high_bit()) {
+            delete buckets[i];
+        }
+    }
+    delete[] buckets;
+}
+
+// copy and swap
+// O(other.nD + bytes)
+template <size_t N> EH_string_set<N>& EH_string_set<N>::operator=(const EH_string_set& other) noexcept {
+    if (this != &other) {
+        EH_string_set temp{other};
+        swap(temp);
+    }
+    return *this;
+}
+
+// clears all values, without losing structur and inserts ilist
+// O(nD + list size)
+template <size_t N> EH_string_set<N>& EH_string_set<N>::operator=(std::initializer_list<key_type> ilist) noexcept {
+    for (size_type i{0}; i < nD; ++i) {
+        Bucket* b = buckets[i];
+        b->arrsz = b->used = b->live = 0;
+    }
+    sz = 0;
+    insert(ilist);
+    return *this;
+}
+
+// O(1)
+template <size_t N> typename EH_string_set<N>::size_type EH_string_set<N>::size() const noexcept { return sz; }
+// O(1)
+template <size_t N> bool EH_string_set<N>::empty() const noexcept { return (sz == 0); }
+
+// insert list: calls iterator insert
+// O(list size)
+template <size_t N> void EH_string_set<N>::insert(std::initializer_list<key_type> ilist) noexcept {
+    insert(std::begin(ilist), std::end(ilist));
+}
+
+// calls private method add
+// O(1)
+template <size_t N>
+std::pair<typename EH_string_set<N>::iterator, bool> EH_string_set<N>::insert(key_type key) noexcept {
+    size_type old_sz{sz};
+    return {add(key), (old_sz != sz)};
+}
+
+// iterator insert calls private method add for every item
+// O(range size)
+template <size_t N>
+template <typename InputIt>
+void EH_string_set<N>::insert(InputIt first, InputIt last) noexcept {
+    for (auto it{first}; it != last; ++it) {
+        add(*it);
+    }
+}
+
+// swap with empty set
+// O(nD) (because Destruktor)
+template <size_t N> void EH_string_set<N>::clear() noexcept {
+    EH_string_set temp{};
+    swap(temp);
+}
+
+// hash and call Bucket remove
+// O(1)
+template <size_t N> typename EH_string_set<N>::size_type EH_string_set<N>::erase(key_type key) noexcept {
+    size_type h{hasher{}(key)};
+    if (buckets[h & (nD - 1)]->remove(key, fingerprint(h))) {
+        --sz;
+        return 1;
+    }
+    return 0;
+}
+
+// hash and call Bucket find
+// O(1)
+template <size_t N> typename EH_string_set<N>::size_type EH_string_set<N>::count(key_type key) const noexcept {
+    size_type h{hasher{}(key)};
+    return buckets[h & (nD - 1)]->find(key, fingerprint(h)) != N;
+}
+
+// hash and call Bucket find
+// O(1)
+template <size_t N> typename EH_string_set<N>::iterator EH_string_set<N>::find(key_type key) const noexcept {
+    size_type h{hasher{}(key)};
+    size_type idx = buckets[h & (nD - 1)]->find(key, fingerprint(h));
+    return idx != N ? iterator(idx, h & (nD - 1), this) : end();
+}
+
+// just uses std::swap for every instance variable
+// O(1)
+template <size_t N> void EH_string_set<N>::swap(EH_string_set& other) noexcept {
+    using std::swap;
+    swap(d, other.d);
+    swap(nD, other.nD);
+    swap(sz, other.sz);
+    swap(buckets, other.buckets);
+}
+
+// begin-iterator is first element of first Bucket
+// O(1)
+template <size_t N> typename EH_string_set<N>::const_iterator EH_string_set<N>::begin() const noexcept {
+    return const_iterator(0, 0, this);
+}
+// end-iterator is first element of (nonexistent) nDth Bucket
+// O(1)
+template <size_t N> typename EH_string_set<N>::const_iterator EH_string_set<N>::end() const noexcept {
+    return const_iterator(this);
+}
+
+// Outputs entire set to ostream
+template <size_t N> void EH_string_set<N>::dump(std::ostream& o) const noexcept {
+    o << "Extendible Hashing <string," << N << ">, d = " << d << ", nD = " << nD << ", sz = " << sz << '\n';
+    // printing...
+    for (size_type i{0}; i < nD; ++i) {
+        Bucket* b = buckets[i];
+        size_type orig_bucket = i & (b->high_bit() - 1);
+        o << i;
+        if (orig_bucket != i) {
+            o << " ~~> " << orig_bucket;  // if pointer isnt first to a bucket show reference to first Bucket
+        }
+        o << " --> [l = " << b->l << ", offset = " << b->high_bit() << ", arrsz = " << b->arrsz
+          << ", arena = " << b->live << '/' << b->capacity << " | ";
+        for (size_type j{0}; j < b->arrsz; ++j) {
+            o << b->key(j) << ' ';
+        }
+        o << "]\n";
+    }
+}
+
+/*---------------------------Iterator Class-------------------------------*/
+
+template <size_t N> class EH_string_set<N>::Iterator {
+  public:
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::string_view;
+    using iterator_category = std::forward_iterator_tag;
+
+    // keys are views created on access, so operator-> needs something to point to
+    struct pointer {
+        std::string_view view;
+        const std::string_view* operator->() const noexcept { return &view; }
+    };
+
+  private:
+    size_type idx{0};
+    const EH_string_set* set{nullptr};
+    size_type b{0};
+
+    // skip to the next, first ptr, that is the first occurence, to point to a
+    // non-empty Bucket
+    void skip() noexcept {
+        while (b >= set->buckets[b]->high_bit() || set->buckets[b]->arrsz == 0) {
+            b++;
+            if (is_end()) {  // if we are at the end ptr, dont increase anymore
+                break;
+            }
+        }
+    }
+
+    // is iterator at the end?
+    [[nodiscard]] bool is_end() const noexcept { return b == set->nD; }
+
+    // returns the current Bucket
+    [[nodiscard]] const Bucket* bucket() const noexcept { return set->buckets[b]; }
+
+  public:
+    explicit Iterator(size_type idx, size_type b, const EH_string_set* set) noexcept
+        : idx{idx}, set{set}, b{b & (set->buckets[b]->high_bit() - 1)} {
+        skip();
+    }
+
+    Iterator(const EH_string_set* set) noexcept : idx{0}, set{set}, b{set->nD} {}  // for end-iterator
+    Iterator() noexcept : idx{0}, set{nullptr}, b{0} {}
+
+    [[nodiscard]] reference operator*() const noexcept { return bucket()->key(idx); }
+    [[nodiscard]] pointer operator->() const noexcept { return {**this}; }
+
+    Iterator& operator++() noexcept {
+        if (++idx < bucket()->arrsz) {
+            return *this;
+        }
+
+        // if we are at the end of current bucket
+        idx = 0;
+        ++b;
+        if (b != set->nD) {  // if we are at the end ptr, dont skip to next valid ptr
+            skip();
+        }
+        return *this;
+    }
+
+    Iterator operator++(int) noexcept {
+        auto temp{*this};
+        ++(*this);
+        return temp;
+    }
+
+    // returns current position of iterator in format {Bucket number, Index in
+    // Bucker}, for debugging
+    std::pair<unsigned, unsigned> get_pos() const noexcept { return {b, idx}; }
+
+    [[nodiscard]] friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+        if (lhs.is_end() || rhs.is_end()) {  // if one of the iterators is the end iterator, test if both are
+            return lhs.is_end() && rhs.is_end();
+        }
+        return lhs.bucket() == rhs.bucket() && lhs.idx == rhs.idx;  // test if they point to the same element
+    }
+    [[nodiscard]] friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept { return !(lhs == rhs); }
+};
+
+template <size_t N> void swap(EH_string_set<N>& lhs, EH_string_set<N>& rhs) noexcept { lhs.swap(rhs); }
+
+#endif  // EH_STRING_SET_H
@@ -0,0 +1,32 @@
+#include "latency.h"
+
+#include <algorithm>
+#include <iomanip>
+
+// column layout of print, all latencies in nanoseconds
+void latency_recorder::print_header(std::ostream& o) {
+    o << std::left << std::setw(8) << "op" << std::right << std::setw(12) << "count" << std::setw(10) << "mean"
+      << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(12) << "max"
+      << "  (ns)\n";
+}
+
+// prints count, mean and percentiles of the counted ops (nearest rank, as the largest latency of its bucket)
+void latency_recorder::print(std::ostream& o) const {
+    o << std::left << std::setw(8) << name << std::right << std::setw(12) << total;
+    if (total == 0) {
+        o << '\n';
+        return;
+    }
+    auto rank = [this](double p) {
+        auto r{static_cast<uint64_t>(p * static_cast<double>(total - 1))};
+        uint64_t seen{0};
+        size_t i{0};
+        while ((seen += counts[i]) <= r) {
+            ++i;
+        }
+        return std::min(highest(i), max);
+    };
+
+    o << std::setw(10) << sum / total << std::setw(10) << rank(0.5) << std::setw(10) << rank(0.99) << std::setw(10)
+      << rank(0.999) << std::setw(12) << max << '\n';
+}
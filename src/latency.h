@@ -0,0 +1,86 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using playground_clock = std::chrono::steady_clock;
+
+// counts the latency of every single operation of one kind in a log-linear histogram (as HdrHistogram does),
+// to report percentiles in fixed memory however many ops are timed. Latencies below 2^sub_bits ns are counted
+// exactly, larger ones in 2^sub_bits sub buckets per power of two, so a percentile is off by less than 1%
+class latency_recorder {
+    static constexpr unsigned sub_bits{7};
+    static constexpr uint64_t sub_count{uint64_t{1} << sub_bits};
+    static constexpr size_t bucket_count{(64 - sub_bits + 1) * sub_count};
+
+    std::string name;
+    std::vector<uint64_t> counts;  // ops per bucket
+    uint64_t total{0};
+    uint64_t sum{0};  // nanoseconds
+    uint64_t max{0};
+
+    // number of significant bits of v, 0 for 0
+    static unsigned bit_width(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+        return v ? 64 - static_cast<unsigned>(__builtin_clzll(v)) : 0;
+#else
+        unsigned w{0};
+        for (; v; v >>= 1) {
+            ++w;
+        }
+        return w;
+#endif
+    }
+
+    // group of the power of two of ns (0 for the exact values), then the sub bucket by the next sub_bits bits
+    static size_t bucket(uint64_t ns) {
+        unsigned width{bit_width(ns)};
+        if (width <= sub_bits) {
+            return static_cast<size_t>(ns);
+        }
+        unsigned shift{width - 1 - sub_bits};
+        return static_cast<size_t>((shift + 1) * sub_count + ((ns >> shift) - sub_count));
+    }
+
+    // largest latency counted in bucket i
+    static uint64_t highest(size_t i) {
+        if (i < sub_count) {
+            return i;
+        }
+        unsigned shift{static_cast<unsigned>(i / sub_count - 1)};
+        return ((sub_count + i % sub_count + 1) << shift) - 1;
+    }
+
+  public:
+    explicit latency_recorder(std::string name) : name{std::move(name)}, counts(bucket_count) {}
+
+    void add(playground_clock::duration d) {
+        auto ns{static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count())};
+        ++counts[bucket(ns)];
+        ++total;
+        sum += ns;
+        max = ns > max ? ns : max;
+    }
+
+    // adds the counts of other, e.g. to sum up threads
+    void merge(const latency_recorder& other) {
+        for (size_t i{0}; i < bucket_count; ++i) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        sum += other.sum;
+        max = other.max > max ? other.max : max;
+    }
+
+    [[nodiscard]] size_t count() const { return total; }
+
+    static void print_header(std::ostream& o);
+    void print(std::ostream& o) const;
+};
+
+#endif  // LATENCY_H
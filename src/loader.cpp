@@ -0,0 +1,154 @@
+#include "loader.h"
+
+#include "latency.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <limits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+static constexpr size_t chunk_size{4096};  // keys handed to insert_batch at once
+
+// read only mapping of a whole file, unmapped on destruction
+class mapped_file {
+    const char* data{nullptr};
+    size_t size{0};
+    bool ok{false};
+
+  public:
+    explicit mapped_file(const std::string& path) {
+        int fd{::open(path.c_str(), O_RDONLY)};
+        if (fd < 0) {
+            return;
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) == 0) {
+            size = static_cast<size_t>(st.st_size);
+            ok = true;
+            if (size > 0) {  // mmap rejects empty mappings
+                void* p{::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)};
+                if (p == MAP_FAILED) {
+                    ok = false;
+                } else {
+                    data = static_cast<const char*>(p);
+                    ::madvise(p, size, MADV_SEQUENTIAL);
+                }
+            }
+        }
+        ::close(fd);
+    }
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    ~mapped_file() {
+        if (data) {
+            ::munmap(const_cast<char*>(data), size);
+        }
+    }
+
+    [[nodiscard]] bool valid() const { return ok; }
+    [[nodiscard]] const char* begin() const { return data; }
+    [[nodiscard]] const char* end() const { return data + size; }
+    [[nodiscard]] size_t length() const { return size; }
+};
+
+static bool ends_with(const std::string& s, const char* suffix) {
+    size_t len{std::strlen(suffix)};
+    return s.size() >= len && s.compare(s.size() - len, len, suffix) == 0;
+}
+
+static bool is_space(char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r'; }
+
+// parses decimal keys with std::from_chars, returns the number of keys or -1 on malformed input
+static long long load_text(const mapped_file& file, set& set) {
+    std::vector<unsigned> chunk{};
+    chunk.reserve(chunk_size);
+    long long keys{0};
+
+    const char* first{file.begin()};
+    const char* last{file.end()};
+    while (true) {
+        while (first != last && is_space(*first)) {
+            ++first;
+        }
+        if (first == last) {
+            break;
+        }
+        unsigned key{};
+        auto [ptr, ec] = std::from_chars(first, last, key);
+        if (ec != std::errc{} || (ptr != last && !is_space(*ptr))) {
+            std::cerr << "invalid key at byte " << first - file.begin() << '\n';
+            return -1;
+        }
+        first = ptr;
+
+        chunk.push_back(key);
+        if (chunk.size() == chunk_size) {
+            set.insert_batch(chunk.data(), chunk.size());
+            keys += static_cast<long long>(chunk.size());
+            chunk.clear();
+        }
+    }
+    set.insert_batch(chunk.data(), chunk.size());
+    return keys + static_cast<long long>(chunk.size());
+}
+
+// reads fixed width little endian keys, returns the number of keys or -1 on malformed input
+template <typename Raw> static long long load_binary(const mapped_file& file, set& set) {
+    if (file.length() % sizeof(Raw) != 0) {
+        std::cerr << "file size is not a multiple of " << sizeof(Raw) << " bytes\n";
+        return -1;
+    }
+    size_t count{file.length() / sizeof(Raw)};
+    set.reserve(set.size() + count);
+
+    unsigned chunk[chunk_size];
+    for (size_t base{0}; base < count; base += chunk_size) {
+        size_t len{std::min(chunk_size, count - base)};
+        for (size_t i{0}; i < len; ++i) {
+            const auto* bytes{reinterpret_cast<const unsigned char*>(file.begin() + (base + i) * sizeof(Raw))};
+            Raw raw{0};
+            for (size_t b{0}; b < sizeof(Raw); ++b) {  // byte order independent of the host
+                raw |= static_cast<Raw>(bytes[b]) << (8 * b);
+            }
+            if (raw > std::numeric_limits<unsigned>::max()) {
+                std::cerr << "key " << raw << " (number " << base + i << ") does not fit into unsigned\n";
+                return -1;
+            }
+            chunk[i] = static_cast<unsigned>(raw);
+        }
+        set.insert_batch(chunk, len);
+    }
+    return static_cast<long long>(count);
+}
+
+bool load_keys(const std::string& path, set& set, std::ostream& out) {
+    mapped_file file{path};
+    if (!file.valid()) {
+        std::cerr << "could not read '" << path << "'\n";
+        return false;
+    }
+
+    size_t before{set.size()};
+    auto start{playground_clock::now()};
+    long long keys{ends_with(path, ".u32")   ? load_binary<uint32_t>(file, set)
+                   : ends_with(path, ".u64") ? load_binary<uint64_t>(file, set)
+                                             : load_text(file, set)};
+    std::chrono::duration<double> elapsed{playground_clock::now() - start};
+    if (keys < 0) {
+        std::cerr << "could not load '" << path << "'\n";
+        return false;
+    }
+
+    out << "loaded " << keys << " keys (" << set.size() - before << " new) from '" << path << "' in " << std::fixed
+        << std::setprecision(3) << elapsed.count() << " s (" << std::setprecision(0)
+        << static_cast<double>(keys) / elapsed.count() << " keys/s)\n"
+        << std::defaultfloat;
+    return true;
+}
@@ -0,0 +1,17 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+#include "playground.h"
+
+#include <iostream>
+#include <string>
+
+// Bulk loads keys from path into set. The file is mapped into memory and read as
+//  - raw little endian uint32 keys if path ends in ".u32"
+//  - raw little endian uint64 keys if path ends in ".u64" (every key has to fit into unsigned)
+//  - decimal text keys separated by whitespace otherwise
+// Keys are fed to EH_set::insert_batch in chunks, a summary goes to out.
+// Returns false (after printing the reason to std::cerr) if the file can't be read or is malformed.
+bool load_keys(const std::string& path, set& set, std::ostream& out);
+
+#endif  // LOADER_H
@@ -1,6 +1,11 @@
-#include "EH_set.h"
+#include "loader.h"
+#include "playground.h"
+#include "replay.h"
+#include "server.h"
+#include "workload.h"
 
 #include <cstdlib>
+#include <fstream>
 #include <getopt.h>
 #include <iostream>
 #include <sstream>
@@ -19,8 +24,6 @@
 #define PROG_DESC "<undefined>"
 #endif
 
-using set = EH_set<unsigned>;
-
 static void print_version() { std::cout << PROG_NAME << " " << PROG_VERSION << "\n"; }
 
 static void print_cli_help() {
@@ -28,9 +31,26 @@ static void print_cli_help() {
     std::cout << PROG_DESC << "\n\nUSAGE:\n"
               << PROG_NAME << " [OPTIONS]\n"
               << "\nOPTIONS:\n"
-              << "   -h, --help      Print this help\n"
-              << "   -v, --verbose   Toggle verbose output. (default: true)\n"
-              << "   -V, --version   Print the program version\n\n"
+              << "   -b, --bind ADDR     IPv4 address --serve listens on (default: 127.0.0.1, only this host)\n"
+              << "   -h, --help          Print this help\n"
+              << "   -l, --load FILE     Bulk load the keys in FILE before starting (or replaying a script).\n"
+              << "                       FILE holds decimal keys separated by whitespace, or raw little endian\n"
+              << "                       uint32 / uint64 keys if it ends in .u32 / .u64\n"
+              << "   -n, --shards N      Number of shards of --serve (default: 1), as many event loop\n"
+              << "                       threads accept connections and each serves all shards\n"
+              << "   -s, --script FILE   Replay the op trace in FILE ('-' for stdin) and report\n"
+              << "                       ops/s and latencies instead of starting interactively\n"
+              << "   -S, --serve PORT    Serve the set over TCP on PORT (0 picks a free one) until SIGINT/SIGTERM,\n"
+              << "                       with a length prefixed binary protocol, see src/server.h\n"
+              << "   -v, --verbose       Toggle verbose output. (default: true)\n"
+              << "   -V, --version       Print the program version\n"
+              << "   -w, --workload SPEC Run a generated workload and report throughput and latencies.\n"
+              << "                       SPEC is a comma separated list of name=value, e.g.\n"
+              << "                       distribution=zipfian,keys=100000,threads=4,read=90,insert=5,erase=5\n"
+              << "                       distributions: uniform (default), zipfian, sequential, latest\n"
+              << "                       further fields: theta (zipfian skew), bucket (N), seed,\n"
+              << "                       growth (directory or linear hashing),\n"
+              << "                       layout (Buckets scanned, sorted or indexed)\n\n"
               << "After Startup, you can enter commands, to manipulate the "
                  "datastructure.\n"
               << "For more Information on the available commands run the "
@@ -45,6 +65,8 @@ static void print_help() {
               << "  l - list all elements in set (using foreach loop)\n"
               << "  s - show size of set\n"
               << "  c - clear set\n"
+              << "  save FILE - write set to FILE in a binary format\n"
+              << "  load FILE - replace set by the one saved in FILE\n"
               << "  p - print current set\n"
               << "  h - show help page (this screen)\n"
               << "  q (or EOF) - quit\n";
@@ -90,16 +112,57 @@ static void find(set* set) {
     }
 }
 
-static void run(bool verbose) {
-    set set{};
+static void save(const set& set, std::istringstream& args) {
+    std::string path;
+    if (!(args >> path)) {
+        std::cout << "usage: save FILE\n";
+        return;
+    }
+    std::ofstream file{path, std::ios::binary};
+    if (file && set.save(file) && file.flush()) {
+        std::cout << "saved " << set.size() << " keys to '" << path << "'\n";
+    } else {
+        std::cout << "could not write '" << path << "'\n";
+    }
+}
+
+// returns true if set was replaced
+static bool load(set& set, std::istringstream& args) {
+    std::string path;
+    if (!(args >> path)) {
+        std::cout << "usage: load FILE\n";
+        return false;
+    }
+    std::ifstream file{path, std::ios::binary};
+    if (!file || !set.load(file)) {
+        std::cout << "could not load '" << path << "'\n";
+        return false;
+    }
+    std::cout << "loaded " << set.size() << " keys from '" << path << "'\n";
+    return true;
+}
+
+static void run(set& set, bool verbose) {
     bool changed{false};
     std::string line{};
 
     while (std::cout << "cmd> ", std::getline(std::cin, line)) {
         changed = false;
         std::istringstream line_stream(line);
-        char cmd;
-        line_stream >> cmd;
+        std::string word;
+        line_stream >> word;
+        if (word == "save") {
+            save(set, line_stream);
+            continue;
+        }
+        if (word == "load") {
+            changed = load(set, line_stream);
+            if (verbose && changed) {
+                set.dump();
+            }
+            continue;
+        }
+        char cmd{word.empty() ? '\0' : word[0]};
 
         switch (cmd) {
             case 'i':
@@ -144,21 +207,66 @@ static void run(bool verbose) {
     }
 }
 
+// replays the trace in path (stdin for "-"), verbose dumps are never printed
+static int run_script(const std::string& path, set& set) {
+    if (path == "-") {
+        return replay(std::cin, set, std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    std::ifstream file{path};
+    if (!file) {
+        std::cerr << "could not open script '" << path << "'\n";
+        return EXIT_FAILURE;
+    }
+    return replay(file, set, std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 int main(int argc, char** argv) {
     int verbose{true};
+    const char* script{nullptr};
+    const char* workload{nullptr};
+    const char* load{nullptr};
+    const char* serve_port{nullptr};
+    const char* shards{"1"};
+    bool shards_given{false};
+    const char* bind_address{"127.0.0.1"};
     static const struct option long_options[] = {{"verbose", no_argument, nullptr, 'v'},
                                                  {"version", no_argument, nullptr, 'V'},
                                                  {"help", no_argument, nullptr, 'h'},
+                                                 {"bind", required_argument, nullptr, 'b'},
+                                                 {"load", required_argument, nullptr, 'l'},
+                                                 {"script", required_argument, nullptr, 's'},
+                                                 {"serve", required_argument, nullptr, 'S'},
+                                                 {"shards", required_argument, nullptr, 'n'},
+                                                 {"workload", required_argument, nullptr, 'w'},
                                                  {nullptr, 0, nullptr, 0}};
 
     int opt{'?'};
-    while ((opt = getopt_long(argc, argv, "vhV", long_options, nullptr)) != -1) {
+    while ((opt = getopt_long(argc, argv, "vhVb:l:s:S:n:w:", long_options, nullptr)) != -1) {
         switch (opt) {
             case 0:
                 break;
             case 'v':
                 verbose = false;
                 break;
+            case 'b':
+                bind_address = optarg;
+                break;
+            case 'l':
+                load = optarg;
+                break;
+            case 's':
+                script = optarg;
+                break;
+            case 'S':
+                serve_port = optarg;
+                break;
+            case 'n':
+                shards = optarg;
+                shards_given = true;
+                break;
+            case 'w':
+                workload = optarg;
+                break;
             case 'V':
                 print_version();
                 return EXIT_SUCCESS;
@@ -174,7 +282,54 @@ int main(int argc, char** argv) {
         }
     }
 
-    run(verbose);
+    if (workload) {
+        if (load) {
+            std::cerr << "--load can't be combined with --workload, it generates its own keys\n";
+            return EXIT_FAILURE;
+        }
+        if (serve_port) {
+            std::cerr << "--serve can't be combined with --workload\n";
+            return EXIT_FAILURE;
+        }
+        workload_spec spec{};
+        if (!parse_workload(workload, spec)) {
+            return EXIT_FAILURE;
+        }
+        run_workload(spec, std::cout);
+        return EXIT_SUCCESS;
+    }
+
+    if (serve_port && script) {
+        std::cerr << "--serve can't be combined with --script\n";
+        return EXIT_FAILURE;
+    }
+    if (shards_given && !serve_port) {
+        std::cerr << "--shards only applies to --serve\n";
+        return EXIT_FAILURE;
+    }
+    uint16_t port{0};
+    size_t shard_count{0};
+    if (serve_port && !parse_number<uint16_t>(serve_port, 0, 65535, port)) {
+        std::cerr << "invalid port '" << serve_port << "'\n";
+        return EXIT_FAILURE;
+    }
+    if (!parse_number<size_t>(shards, 1, 1024, shard_count)) {
+        std::cerr << "invalid number of shards '" << shards << "', expected 1 to 1024\n";
+        return EXIT_FAILURE;
+    }
+
+    set set{};
+    if (load && !load_keys(load, set, std::cout)) {
+        return EXIT_FAILURE;
+    }
+    if (serve_port) {
+        return serve(bind_address, port, shard_count, set, std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (script) {
+        return run_script(script, set);
+    }
+
+    run(set, verbose);
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,25 @@
+#ifndef PLAYGROUND_H
+#define PLAYGROUND_H
+
+#include "EH_set.h"
+
+#include <charconv>
+#include <string_view>
+#include <system_error>
+
+// the set every playground mode works on
+using set = EH_set<unsigned>;
+
+// parses a whole decimal number in [min, max] into value, returns false and leaves value alone otherwise
+// (from_chars takes no sign for unsigned types, so "-1" is rejected instead of wrapping around)
+template <typename T> bool parse_number(std::string_view text, T min, T max, T& value) {
+    T parsed{};
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+    if (ec != std::errc{} || ptr != text.data() + text.size() || text.empty() || parsed < min || parsed > max) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+#endif  // PLAYGROUND_H
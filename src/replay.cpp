@@ -0,0 +1,93 @@
+#include "replay.h"
+
+#include "latency.h"
+
+#include <charconv>
+#include <iomanip>
+#include <string>
+#include <string_view>
+
+// latencies per kind of op
+struct replay_stats {
+    latency_recorder inserts{"insert"};
+    latency_recorder removes{"remove"};
+    latency_recorder finds{"find"};
+    latency_recorder clears{"clear"};
+    size_t found{0};
+};
+
+// applies op to every key on the rest of the line, returns false on anything that is not a key
+template <typename Op> static bool for_each_key(std::string_view keys, latency_recorder& rec, Op op) {
+    const char* first{keys.data()};
+    const char* last{keys.data() + keys.size()};
+    while (true) {
+        while (first != last && (*first == ' ' || *first == '\t' || *first == '\r')) {
+            ++first;
+        }
+        if (first == last) {
+            return true;
+        }
+        unsigned key{};
+        auto [ptr, ec] = std::from_chars(first, last, key);
+        if (ec != std::errc{} || (ptr != last && *ptr != ' ' && *ptr != '\t' && *ptr != '\r')) {
+            return false;
+        }
+        first = ptr;
+
+        auto start{playground_clock::now()};
+        op(key);
+        rec.add(playground_clock::now() - start);
+    }
+}
+
+static bool replay_line(std::string_view line, set& set, replay_stats& stats) {
+    size_t cmd_pos{line.find_first_not_of(" \t\r")};
+    if (cmd_pos == std::string_view::npos || line[cmd_pos] == '#') {
+        return true;
+    }
+    std::string_view args{line.substr(cmd_pos + 1)};
+    switch (line[cmd_pos]) {
+        case 'i':
+            return for_each_key(args, stats.inserts, [&set](unsigned key) { set.insert(key); });
+        case 'r':
+            return for_each_key(args, stats.removes, [&set](unsigned key) { set.erase(key); });
+        case 'f':
+            return for_each_key(args, stats.finds, [&set, &stats](unsigned key) { stats.found += set.count(key); });
+        case 'c': {
+            auto start{playground_clock::now()};
+            set.clear();
+            stats.clears.add(playground_clock::now() - start);
+            return args.find_first_not_of(" \t\r") == std::string_view::npos;
+        }
+        default:
+            return false;
+    }
+}
+
+bool replay(std::istream& in, set& set, std::ostream& out) {
+    replay_stats stats{};
+    std::string line{};
+    size_t line_nr{0};
+
+    auto start{playground_clock::now()};
+    while (std::getline(in, line)) {
+        ++line_nr;
+        if (!replay_line(line, set, stats)) {
+            std::cerr << "malformed trace in line " << line_nr << ": " << line << '\n';
+            return false;
+        }
+    }
+    std::chrono::duration<double> elapsed{playground_clock::now() - start};
+
+    size_t ops{stats.inserts.count() + stats.removes.count() + stats.finds.count() + stats.clears.count()};
+    out << "replayed " << ops << " ops from " << line_nr << " lines in " << std::fixed << std::setprecision(3)
+        << elapsed.count() << " s (" << std::setprecision(0) << static_cast<double>(ops) / elapsed.count()
+        << " ops/s, including parsing)\n"
+        << "final size " << set.size() << ", found " << stats.found << " of " << stats.finds.count() << " keys\n";
+    latency_recorder::print_header(out);
+    stats.inserts.print(out);
+    stats.removes.print(out);
+    stats.finds.print(out);
+    stats.clears.print(out);
+    return true;
+}
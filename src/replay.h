@@ -0,0 +1,18 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "playground.h"
+
+#include <iostream>
+
+// Replays an op trace at full speed, one op per line:
+//   i KEY...   insert keys
+//   r KEY...   remove keys
+//   f KEY...   find keys
+//   c          clear the set
+// empty lines and lines starting with '#' are skipped.
+// Every key is timed as a single op, the report with ops/s and latency percentiles goes to out.
+// Returns false (after reporting the line to std::cerr) if the trace is malformed.
+bool replay(std::istream& in, set& set, std::ostream& out);
+
+#endif  // REPLAY_H
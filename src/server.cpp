@@ -0,0 +1,488 @@
+#include "server.h"
+
+#include "latency.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+static constexpr uint32_t max_frame{1u << 20};  // longest accepted request, without the length field
+static constexpr size_t read_chunk{64 * 1024};  // bytes read from a client at once
+static constexpr int max_events{64};            // events taken from epoll at once
+// how long a loop stops accepting after it ran out of descriptors
+static constexpr std::chrono::milliseconds accept_pause{100};
+
+// file descriptor, closed on destruction
+class unique_fd {
+    int fd;
+
+  public:
+    explicit unique_fd(int fd = -1) : fd{fd} {}
+    unique_fd(const unique_fd&) = delete;
+    unique_fd& operator=(const unique_fd&) = delete;
+    ~unique_fd() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    [[nodiscard]] bool valid() const { return fd >= 0; }
+    [[nodiscard]] int get() const { return fd; }
+};
+
+// part of the keys, picked by shard_of
+struct shard {
+    std::mutex mutex{};
+    set keys{};
+};
+
+// spreads keys independent of the low bits the directory of a shard uses
+static size_t shard_of(unsigned key, size_t shards) {
+    return static_cast<size_t>((uint64_t{key} * 0x9E3779B97F4A7C15ull) >> 32) % shards;
+}
+
+template <typename T> static void put_le(std::vector<char>& out, T value) {
+    for (size_t i{0}; i < sizeof(T); ++i) {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+static uint32_t get_le32(const char* p) {
+    uint32_t value{0};
+    for (size_t i{4}; i-- > 0;) {
+        value = value << 8 | static_cast<unsigned char>(p[i]);
+    }
+    return value;
+}
+
+// writes the length of the frame that starts at out[at]
+static void finish_frame(std::vector<char>& out, size_t at) {
+    auto len{static_cast<uint32_t>(out.size() - at - 4)};
+    for (size_t i{0}; i < 4; ++i) {
+        out[at + i] = static_cast<char>(len >> (8 * i));
+    }
+}
+
+// a client with the bytes that were not processed or not sent yet
+struct connection {
+    std::vector<char> in{};
+    size_t used{0};
+    std::vector<char> out{};
+    size_t sent{0};
+    bool writing{false};  // waiting for EPOLLOUT, reading is paused until out is sent
+    bool closing{false};  // close once out is sent
+};
+
+// what one event loop served
+struct loop_stats {
+    size_t connections{0};
+    size_t requests{0};
+    size_t keys{0};
+};
+
+// event loop of one thread, all loops share the listening socket and the stop eventfd
+class event_loop {
+    std::vector<shard>& shards;
+    int listen_fd;
+    int stop_fd;
+    unique_fd epoll_fd;
+    std::unordered_map<int, connection> clients{};
+
+    // scratch space of one request: its keys, and their keys and positions per shard
+    std::vector<unsigned> keys{};
+    std::vector<std::vector<unsigned>> shard_keys;
+    std::vector<std::vector<uint32_t>> shard_pos;
+    std::unique_ptr<bool[]> found{};
+    size_t found_size{0};
+
+    // the listener is level triggered, so after an accept error like EMFILE it is taken out of epoll
+    // until resume instead of waking the loop again right away
+    bool accepting{true};
+    playground_clock::time_point resume{};
+
+  public:
+    loop_stats stats{};
+
+    event_loop(std::vector<shard>& shards, int listen_fd, int stop_fd)
+        : shards{shards}, listen_fd{listen_fd}, stop_fd{stop_fd}, epoll_fd{::epoll_create1(EPOLL_CLOEXEC)},
+          shard_keys(shards.size()), shard_pos(shards.size()) {}
+    event_loop(const event_loop&) = delete;
+    event_loop& operator=(const event_loop&) = delete;
+    ~event_loop() {
+        for (auto& client : clients) {
+            ::close(client.first);
+        }
+    }
+
+    // registers the shared descriptors, returns false on failure
+    bool init() {
+        if (!epoll_fd.valid() || !watch_listener()) {
+            return false;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = stop_fd;
+        return ::epoll_ctl(epoll_fd.get(), EPOLL_CTL_ADD, stop_fd, &ev) == 0;
+    }
+
+    // serves clients until stop_fd becomes readable
+    void run() {
+        epoll_event events[max_events];
+        while (true) {
+            int timeout{-1};
+            if (!accepting) {
+                auto left{std::chrono::ceil<std::chrono::milliseconds>(resume - playground_clock::now())};
+                timeout = static_cast<int>(std::max<std::chrono::milliseconds::rep>(left.count(), 0));
+            }
+            int n{::epoll_wait(epoll_fd.get(), events, max_events, timeout)};
+            if (!accepting && playground_clock::now() >= resume) {
+                accepting = watch_listener();  // retried after the next pause if it fails
+                resume = playground_clock::now() + accept_pause;
+            }
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            for (int i{0}; i < n; ++i) {
+                int fd{events[i].data.fd};
+                if (fd == stop_fd) {
+                    return;
+                }
+                if (fd == listen_fd) {
+                    accept_all();
+                    continue;
+                }
+                auto it{clients.find(fd)};
+                if (it == clients.end()) {
+                    continue;
+                }
+                bool ok{(events[i].events & EPOLLERR) == 0};
+                if (ok && it->second.writing) {
+                    ok = on_writable(fd, it->second);
+                } else if (ok) {
+                    ok = on_readable(fd, it->second);
+                }
+                if (!ok) {
+                    close_client(it);
+                }
+            }
+        }
+    }
+
+  private:
+    bool watch_listener() {
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLEXCLUSIVE;  // wake only one loop per new connection
+        ev.data.fd = listen_fd;
+        return ::epoll_ctl(epoll_fd.get(), EPOLL_CTL_ADD, listen_fd, &ev) == 0;
+    }
+
+    void accept_all() {
+        while (true) {
+            // fails with EAGAIN once the backlog is empty, or another loop was faster
+            int fd{::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)};
+            if (fd < 0 && (errno == EINTR || errno == ECONNABORTED)) {
+                continue;
+            }
+            if (fd < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && accepting) {  // e.g. EMFILE, the backlog stays
+                    ::epoll_ctl(epoll_fd.get(), EPOLL_CTL_DEL, listen_fd, nullptr);
+                    accepting = false;
+                    resume = playground_clock::now() + accept_pause;
+                }
+                return;
+            }
+            int one{1};
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            if (::epoll_ctl(epoll_fd.get(), EPOLL_CTL_ADD, fd, &ev) != 0) {
+                ::close(fd);
+                continue;
+            }
+            clients.emplace(fd, connection{});
+            ++stats.connections;
+        }
+    }
+
+    void close_client(std::unordered_map<int, connection>::iterator it) {
+        ::close(it->first);  // also removes it from epoll
+        clients.erase(it);
+    }
+
+    // switches between waiting for requests and waiting to send the replies
+    bool watch(int fd, connection& c, bool writing) {
+        if (c.writing == writing) {
+            return true;
+        }
+        c.writing = writing;
+        epoll_event ev{};
+        ev.events = writing ? EPOLLOUT : EPOLLIN;
+        ev.data.fd = fd;
+        return ::epoll_ctl(epoll_fd.get(), EPOLL_CTL_MOD, fd, &ev) == 0;
+    }
+
+    // returns false if the connection has to be closed
+    bool on_readable(int fd, connection& c) {
+        if (c.in.size() < c.used + read_chunk) {
+            c.in.resize(c.used + read_chunk);
+        }
+        ssize_t n{::read(fd, c.in.data() + c.used, read_chunk)};
+        if (n < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        if (n == 0) {
+            return false;  // closed by the client
+        }
+        c.used += static_cast<size_t>(n);
+        process(c);
+        return flush(fd, c);
+    }
+
+    bool on_writable(int fd, connection& c) { return flush(fd, c); }
+
+    // sends as much of out as possible, returns false if the connection has to be closed
+    bool flush(int fd, connection& c) {
+        while (c.sent < c.out.size()) {
+            ssize_t n{::send(fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL)};
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return watch(fd, c, true);
+                }
+                return false;
+            }
+            c.sent += static_cast<size_t>(n);
+        }
+        c.out.clear();
+        c.sent = 0;
+        return !c.closing && watch(fd, c, false);
+    }
+
+    // answers every complete request in the input buffer
+    void process(connection& c) {
+        size_t at{0};
+        while (!c.closing && c.used - at >= 4) {
+            uint32_t len{get_le32(c.in.data() + at)};
+            if (len == 0 || len > max_frame || (len - 1) % 4 != 0) {
+                reply_error(c, "invalid request length");
+                break;
+            }
+            if (c.used - at - 4 < len) {
+                break;  // incomplete, wait for more bytes
+            }
+            handle(c, c.in[at + 4], c.in.data() + at + 5, (len - 1) / 4);
+            at += 4 + size_t{len};
+        }
+        std::memmove(c.in.data(), c.in.data() + at, c.used - at);
+        c.used -= at;
+    }
+
+    void reply_error(connection& c, const char* message) {
+        size_t at{c.out.size()};
+        put_le(c.out, uint32_t{0});
+        c.out.push_back('e');
+        c.out.insert(c.out.end(), message, message + std::strlen(message));
+        finish_frame(c.out, at);
+        c.closing = true;
+    }
+
+    // calls f(set, keys, n, pos) for the keys of every shard under its lock,
+    // pos maps them back to their index in the request (nullptr for the identity)
+    template <typename F> void for_each_shard(F f) {
+        if (shards.size() == 1) {
+            std::lock_guard<std::mutex> lock{shards[0].mutex};
+            f(shards[0].keys, keys.data(), keys.size(), static_cast<const uint32_t*>(nullptr));
+            return;
+        }
+        for (size_t s{0}; s < shards.size(); ++s) {
+            shard_keys[s].clear();
+            shard_pos[s].clear();
+        }
+        for (size_t i{0}; i < keys.size(); ++i) {
+            size_t s{shard_of(keys[i], shards.size())};
+            shard_keys[s].push_back(keys[i]);
+            shard_pos[s].push_back(static_cast<uint32_t>(i));
+        }
+        for (size_t s{0}; s < shards.size(); ++s) {
+            if (!shard_keys[s].empty()) {
+                std::lock_guard<std::mutex> lock{shards[s].mutex};
+                f(shards[s].keys, shard_keys[s].data(), shard_keys[s].size(), shard_pos[s].data());
+            }
+        }
+    }
+
+    bool* found_buffer(size_t n) {
+        if (found_size < n) {
+            found.reset(new bool[n]);
+            found_size = n;
+        }
+        return found.get();
+    }
+
+    void handle(connection& c, char op, const char* payload, size_t n) {
+        if (op != 'i' && op != 'r' && op != 'c' && op != 'f' && (op != 's' || n != 0)) {
+            reply_error(c, op == 's' ? "size takes no keys" : "unknown op");
+            return;
+        }
+        keys.resize(n);
+        for (size_t i{0}; i < n; ++i) {
+            keys[i] = get_le32(payload + 4 * i);
+        }
+        ++stats.requests;
+        stats.keys += n;
+
+        size_t at{c.out.size()};
+        put_le(c.out, uint32_t{0});
+        c.out.push_back(op);
+        uint64_t total{0};
+        switch (op) {
+            case 'i':
+                for_each_shard([&total](set& set, const unsigned* k, size_t m, const uint32_t*) {
+                    size_t before{set.size()};
+                    set.insert_batch(k, m);
+                    total += set.size() - before;
+                });
+                put_le(c.out, static_cast<uint32_t>(total));
+                break;
+            case 'r':
+                for_each_shard([&total](set& set, const unsigned* k, size_t m, const uint32_t*) {
+                    for (size_t j{0}; j < m; ++j) {
+                        total += set.erase(k[j]);
+                    }
+                });
+                put_le(c.out, static_cast<uint32_t>(total));
+                break;
+            case 'c':
+                for_each_shard([this, &total](set& set, const unsigned* k, size_t m, const uint32_t*) {
+                    bool* hit{found_buffer(m)};
+                    set.count_batch(k, m, hit);
+                    for (size_t j{0}; j < m; ++j) {
+                        total += hit[j];
+                    }
+                });
+                put_le(c.out, static_cast<uint32_t>(total));
+                break;
+            case 'f': {
+                size_t body{c.out.size()};
+                c.out.resize(body + n);
+                for_each_shard([this, &c, body](set& set, const unsigned* k, size_t m, const uint32_t* pos) {
+                    bool* hit{found_buffer(m)};
+                    set.count_batch(k, m, hit);
+                    for (size_t j{0}; j < m; ++j) {
+                        c.out[body + (pos ? pos[j] : j)] = hit[j];
+                    }
+                });
+                break;
+            }
+            default:  // 's'
+                for (shard& s : shards) {
+                    std::lock_guard<std::mutex> lock{s.mutex};
+                    total += s.keys.size();
+                }
+                put_le(c.out, total);
+        }
+        finish_frame(c.out, at);
+    }
+};
+
+bool serve(const char* address, uint16_t port, size_t shard_count, const set& initial, std::ostream& out) {
+    if (shard_count == 0) {
+        std::cerr << "serve: need at least one shard\n";
+        return false;
+    }
+    std::vector<shard> shards(shard_count);
+    for (unsigned key : initial) {
+        shards[shard_of(key, shard_count)].keys.insert(key);
+    }
+
+    unique_fd listener{::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (::inet_pton(AF_INET, address, &addr.sin_addr) != 1) {
+        std::cerr << "serve: invalid IPv4 address '" << address << "'\n";
+        return false;
+    }
+    socklen_t addr_len{sizeof(addr)};
+    int one{1};
+    if (!listener.valid() || ::setsockopt(listener.get(), SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+        ::bind(listener.get(), reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listener.get(), SOMAXCONN) != 0 ||
+        ::getsockname(listener.get(), reinterpret_cast<sockaddr*>(&addr), &addr_len) != 0) {
+        std::cerr << "serve: could not listen on " << address << " port " << port << ": " << std::strerror(errno)
+                  << '\n';
+        return false;
+    }
+    unique_fd stop{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)};
+    std::vector<std::unique_ptr<event_loop>> loops{};
+    for (size_t i{0}; i < shard_count; ++i) {
+        loops.push_back(std::make_unique<event_loop>(shards, listener.get(), stop.get()));
+        if (!stop.valid() || !loops.back()->init()) {
+            std::cerr << "serve: could not set up the event loops: " << std::strerror(errno) << '\n';
+            return false;
+        }
+    }
+
+    // the signals are blocked in every thread, only sigwait below takes them
+    sigset_t stop_signals{};
+    sigset_t old_signals{};
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, &old_signals);
+
+    out << "listening on " << address << " port " << ntohs(addr.sin_port) << " with " << shard_count << " shard(s)"
+        << std::endl;
+    auto start{playground_clock::now()};
+    std::vector<std::thread> threads{};
+    for (auto& loop : loops) {
+        threads.emplace_back([&loop] { loop->run(); });
+    }
+    int sig{0};
+    sigwait(&stop_signals, &sig);
+    uint64_t wake{1};
+    [[maybe_unused]] ssize_t written{::write(stop.get(), &wake, sizeof(wake))};
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    std::chrono::duration<double> elapsed{playground_clock::now() - start};
+    pthread_sigmask(SIG_SETMASK, &old_signals, nullptr);
+
+    loop_stats total{};
+    for (auto& loop : loops) {
+        total.connections += loop->stats.connections;
+        total.requests += loop->stats.requests;
+        total.keys += loop->stats.keys;
+    }
+    size_t size{0};
+    for (shard& s : shards) {
+        size += s.keys.size();
+    }
+    out << "served " << total.requests << " requests with " << total.keys << " keys on " << total.connections
+        << " connections in " << std::fixed << std::setprecision(3) << elapsed.count() << " s ("
+        << std::setprecision(0) << static_cast<double>(total.keys) / elapsed.count() << " keys/s), final size "
+        << size << '\n';
+    return true;
+}
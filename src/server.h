@@ -0,0 +1,31 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "playground.h"
+
+#include <cstdint>
+#include <iostream>
+
+// Serves the set over TCP on the IPv4 address and port (0 picks a free one) until SIGINT or SIGTERM.
+// The protocol has no authentication, so the playground listens on 127.0.0.1 unless told otherwise.
+// The keys are spread over shards EH_sets, each behind its own mutex, and shards epoll event loop
+// threads accept connections. Loops are not tied to a shard, every loop locks whichever shards a request
+// touches. The keys of initial are copied into the shards.
+//
+// Protocol, all integers little endian: a request is a frame
+//   uint32 length, uint8 op, (length - 1) / 4 uint32 keys
+// and is answered by a frame uint32 length, uint8 op, body with
+//   'i' insert keys   body uint32 number of keys that were new
+//   'r' erase keys    body uint32 number of keys that were erased
+//   'c' count keys    body uint32 number of keys that were found
+//   'f' find keys     body one byte per key, 1 if it was found
+//   's' size          (no keys) body uint64 number of keys in all shards
+// Clients may pipeline any number of requests, they are answered in order. The keys of one request
+// are grouped by shard, so every shard is locked once per request and uses the batched set operations.
+// A malformed request (unknown op, bad length, more than 1 MiB) is answered with op 'e' and an
+// error message as body, then the connection is closed.
+// Prints "listening on ADDRESS port P" once ready and a throughput summary to out when stopped.
+// Returns false (after printing the reason to std::cerr) if the server could not be set up.
+bool serve(const char* address, uint16_t port, size_t shards, const set& initial, std::ostream& out);
+
+#endif  // SERVER_H
@@ -0,0 +1,294 @@
+#include "workload.h"
+
+#include "EH_linear_set.h"
+#include "latency.h"
+#include "playground.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using rng_type = std::mt19937_64;
+
+// Zipfian ranks in [0, n) after Gray et al., "Quickly Generating Billion-Record Synthetic Databases"
+// (as used by YCSB). n may grow, zeta is then extended instead of recomputed
+class zipfian_generator {
+    double theta;
+    double alpha;
+    double zeta2;
+    double zetan{0};
+    double eta{0};
+    size_t n{0};
+
+  public:
+    zipfian_generator(double theta, size_t n) : theta{theta}, alpha{1 / (1 - theta)}, zeta2{1 + std::pow(0.5, theta)} {
+        grow(n);
+    }
+
+    void grow(size_t new_n) {
+        for (; n < new_n; ++n) {
+            zetan += 1 / std::pow(static_cast<double>(n + 1), theta);
+        }
+        eta = (1 - std::pow(2.0 / static_cast<double>(n), 1 - theta)) / (1 - zeta2 / zetan);
+    }
+
+    size_t next(rng_type& rng) {
+        double u{std::uniform_real_distribution<double>{}(rng)};
+        double uz{u * zetan};
+        if (uz < 1) {
+            return 0;
+        }
+        if (uz < zeta2) {
+            return 1;
+        }
+        auto rank{static_cast<size_t>(static_cast<double>(n) * std::pow(eta * u - eta + 1, alpha))};
+        return rank < n ? rank : n - 1;
+    }
+};
+
+// picks existing keys (0..n-1) by the distribution of the workload
+class key_chooser {
+    enum class kind { uniform, zipfian, sequential, latest };
+
+    kind k;
+    size_t n;
+    size_t cursor{0};
+    std::optional<zipfian_generator> zipf{};  // only for zipfian and latest, building it costs O(n) pow calls
+
+  public:
+    key_chooser(const workload_spec& spec, size_t n)
+        : k{spec.distribution == "zipfian"      ? kind::zipfian
+            : spec.distribution == "sequential" ? kind::sequential
+            : spec.distribution == "latest"     ? kind::latest
+                                                : kind::uniform},
+          n{n} {
+        if (k == kind::zipfian || k == kind::latest) {
+            zipf.emplace(spec.theta, n);
+        }
+    }
+
+    void grow(size_t new_n) {
+        n = new_n;
+        if (zipf) {
+            zipf->grow(n);
+        }
+    }
+
+    unsigned next(rng_type& rng) {
+        switch (k) {
+            case kind::zipfian:
+                return static_cast<unsigned>(zipf->next(rng));
+            case kind::sequential:
+                return static_cast<unsigned>(cursor++ % n);
+            case kind::latest:
+                return static_cast<unsigned>(n - 1 - zipf->next(rng));
+            default:
+                return static_cast<unsigned>(rng() % n);
+        }
+    }
+};
+
+// what one thread measured
+struct thread_result {
+    latency_recorder reads{"read"};
+    latency_recorder inserts{"insert"};
+    latency_recorder erases{"erase"};
+    playground_clock::duration load{};
+    playground_clock::duration run{};
+    size_t found{0};
+    size_t final_size{0};
+};
+
+// set of one thread: EH_linear_set, or EH_set with the Bucket layout Layout
+template <size_t N, typename Growth, typename Layout>
+using driven_set = std::conditional_t<std::is_same_v<Growth, EH_linear_growth>, EH_linear_set<unsigned, N>,
+                                      EH_set<unsigned, N, false, EH_split_on_overflow, Layout>>;
+
+// load and run phase of one thread on its own set with N keys per Bucket, the growth policy Growth
+// and the Bucket layout Layout
+template <size_t N, typename Growth, typename Layout>
+static void drive(const workload_spec& spec, size_t keys, size_t ops, unsigned seed, thread_result& res) {
+    driven_set<N, Growth, Layout> set{};
+
+    auto start{playground_clock::now()};
+    for (unsigned key{0}; key < keys; ++key) {
+        set.insert(key);
+    }
+    res.load = playground_clock::now() - start;
+
+    rng_type rng{seed};
+    key_chooser chooser{spec, keys};
+    auto next_key{static_cast<unsigned>(keys)};
+
+    start = playground_clock::now();
+    for (size_t i{0}; i < ops; ++i) {
+        auto dice{static_cast<unsigned>(rng() % 100)};
+        if (dice < spec.read) {
+            unsigned key{chooser.next(rng)};
+            auto op_start{playground_clock::now()};
+            res.found += set.count(key);
+            res.reads.add(playground_clock::now() - op_start);
+        } else if (dice < spec.read + spec.insert) {
+            unsigned key{next_key++};
+            auto op_start{playground_clock::now()};
+            set.insert(key);
+            res.inserts.add(playground_clock::now() - op_start);
+            chooser.grow(next_key);
+        } else {
+            unsigned key{chooser.next(rng)};
+            auto op_start{playground_clock::now()};
+            set.erase(key);
+            res.erases.add(playground_clock::now() - op_start);
+        }
+    }
+    res.run = playground_clock::now() - start;
+    res.final_size = set.size();
+}
+
+bool parse_workload(const std::string& text, workload_spec& spec) {
+    std::istringstream in{text};
+    std::string item{};
+    while (std::getline(in, item, ',')) {
+        size_t eq{item.find('=')};
+        if (eq == std::string::npos) {
+            std::cerr << "workload: expected name=value, got '" << item << "'\n";
+            return false;
+        }
+        std::string name{item.substr(0, eq)};
+        std::string value{item.substr(eq + 1)};
+
+        bool ok{true};
+        if (name == "distribution") {
+            spec.distribution = value;
+            ok = value == "uniform" || value == "zipfian" || value == "sequential" || value == "latest";
+        } else if (name == "keys") {
+            ok = parse_number<size_t>(value, 1, max_keys, spec.keys);
+        } else if (name == "ops") {
+            ok = parse_number<size_t>(value, 0, max_ops, spec.ops);
+        } else if (name == "threads") {
+            ok = parse_number<size_t>(value, 1, max_threads, spec.threads);
+        } else if (name == "read") {
+            ok = parse_number(value, 0u, 100u, spec.read);
+        } else if (name == "insert") {
+            ok = parse_number(value, 0u, 100u, spec.insert);
+        } else if (name == "erase") {
+            ok = parse_number(value, 0u, 100u, spec.erase);
+        } else if (name == "theta") {
+            ok = parse_number(value, 0.0, 1.0, spec.theta);
+        } else if (name == "bucket") {
+            ok = parse_number<size_t>(value, 4, 512, spec.bucket);
+        } else if (name == "growth") {
+            spec.growth = value;
+        } else if (name == "layout") {
+            spec.layout = value;
+        } else if (name == "seed") {
+            ok = parse_number(value, 0u, std::numeric_limits<unsigned>::max(), spec.seed);
+        } else {
+            std::cerr << "workload: unknown field '" << name << "'\n";
+            return false;
+        }
+        if (!ok) {
+            std::cerr << "workload: invalid value '" << value << "' for " << name << '\n';
+            return false;
+        }
+    }
+
+    if (spec.read + spec.insert + spec.erase != 100) {
+        std::cerr << "workload: read, insert and erase have to add up to 100\n";
+        return false;
+    }
+    if (spec.threads == 0 || spec.keys < spec.threads) {
+        std::cerr << "workload: need at least one thread and one key per thread\n";
+        return false;
+    }
+    if (!(spec.theta > 0 && spec.theta < 1)) {
+        std::cerr << "workload: theta has to be in (0, 1)\n";
+        return false;
+    }
+    if (spec.bucket < 4 || spec.bucket > 512 || (spec.bucket & (spec.bucket - 1)) != 0) {
+        std::cerr << "workload: bucket has to be a power of two from 4 to 512\n";
+        return false;
+    }
+    if (spec.growth != "directory" && spec.growth != "linear") {
+        std::cerr << "workload: growth has to be directory or linear\n";
+        return false;
+    }
+    if (spec.layout != "scan" && spec.layout != "sorted" && spec.layout != "indexed") {
+        std::cerr << "workload: layout has to be scan, sorted or indexed\n";
+        return false;
+    }
+    if (spec.growth == "linear" && spec.layout != "scan") {
+        std::cerr << "workload: linear growth only scans its Buckets\n";
+        return false;
+    }
+    return true;
+}
+
+using drive_fn = void (*)(const workload_spec&, size_t, size_t, unsigned, thread_result&);
+
+template <typename Growth, typename Layout> static drive_fn pick_drive(size_t bucket) {
+    return bucket == 4     ? drive<4, Growth, Layout>
+           : bucket == 8   ? drive<8, Growth, Layout>
+           : bucket == 32  ? drive<32, Growth, Layout>
+           : bucket == 64  ? drive<64, Growth, Layout>
+           : bucket == 128 ? drive<128, Growth, Layout>
+           : bucket == 256 ? drive<256, Growth, Layout>
+           : bucket == 512 ? drive<512, Growth, Layout>
+                           : drive<16, Growth, Layout>;
+}
+
+void run_workload(const workload_spec& spec, std::ostream& out) {
+    drive_fn drive_n{spec.growth == "linear"   ? pick_drive<EH_linear_growth, EH_scan_layout>(spec.bucket)
+                     : spec.layout == "sorted"  ? pick_drive<EH_directory_growth, EH_sorted_layout>(spec.bucket)
+                     : spec.layout == "indexed" ? pick_drive<EH_directory_growth, EH_indexed_layout>(spec.bucket)
+                                                : pick_drive<EH_directory_growth, EH_scan_layout>(spec.bucket)};
+
+    std::vector<thread_result> results(spec.threads);
+    std::vector<std::thread> threads{};
+    for (size_t t{0}; t < spec.threads; ++t) {
+        // the first threads take the remainder of keys and ops
+        size_t keys{spec.keys / spec.threads + (t < spec.keys % spec.threads)};
+        size_t ops{spec.ops / spec.threads + (t < spec.ops % spec.threads)};
+        threads.emplace_back(drive_n, std::cref(spec), keys, ops, spec.seed + static_cast<unsigned>(t),
+                             std::ref(results[t]));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // throughput is bounded by the slowest thread
+    thread_result total{};
+    for (const auto& res : results) {
+        total.reads.merge(res.reads);
+        total.inserts.merge(res.inserts);
+        total.erases.merge(res.erases);
+        total.load = std::max(total.load, res.load);
+        total.run = std::max(total.run, res.run);
+        total.found += res.found;
+        total.final_size += res.final_size;
+    }
+    std::chrono::duration<double> load{total.load};
+    std::chrono::duration<double> run{total.run};
+
+    out << "workload " << spec.distribution << ", " << spec.keys << " keys, " << spec.ops << " ops, " << spec.threads
+        << " threads, N = " << spec.bucket << ", " << spec.growth << " growth, " << spec.layout << " layout, read "
+        << spec.read << "% insert " << spec.insert << "% erase " << spec.erase << "%\n"
+        << std::fixed << std::setprecision(3) << "load: " << spec.keys << " keys in " << load.count() << " s ("
+        << std::setprecision(0) << static_cast<double>(spec.keys) / load.count() << " ops/s)\n"
+        << std::setprecision(3) << "run: " << spec.ops << " ops in " << run.count() << " s (" << std::setprecision(0)
+        << static_cast<double>(spec.ops) / run.count() << " ops/s)\n"
+        << "final size " << total.final_size << ", found " << total.found << " of " << total.reads.count()
+        << " reads\n";
+    latency_recorder::print_header(out);
+    total.reads.print(out);
+    total.inserts.print(out);
+    total.erases.print(out);
+}
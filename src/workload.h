@@ -0,0 +1,44 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <iostream>
+#include <string>
+
+// YCSB like workload: a load phase inserts keys 0..keys-1, then the run phase performs ops,
+// picking read/insert/erase by the given percentages. Inserts always add the next new key,
+// reads and erases pick keys from the chosen distribution:
+//   uniform     every inserted key is equally likely
+//   zipfian     key i is picked with probability ~ 1 / (i+1)^theta, low keys are hot
+//   sequential  walks through the inserted keys in order, wrapping around
+//   latest      zipfian by age, the most recently inserted keys are hot
+// EH_set is not thread safe, so every thread drives its own set with keys / threads keys
+// and ops / threads ops, the report sums them up.
+struct workload_spec {
+    std::string distribution{"uniform"};
+    size_t keys{100'000};
+    size_t ops{1'000'000};
+    size_t threads{1};
+    unsigned read{90};    // percent
+    unsigned insert{5};   // percent
+    unsigned erase{5};    // percent
+    double theta{0.99};   // skew of zipfian and latest
+    size_t bucket{16};    // keys per Bucket (N), a power of two from 4 to 512
+    unsigned seed{42};
+    std::string growth{"directory"};  // directory (EH_set) or linear (EH_linear_set)
+    std::string layout{"scan"};       // Bucket layout of EH_set: scan, sorted or indexed
+};
+
+// upper bounds parse_workload accepts, keys and inserted keys have to fit the unsigned keys of the set
+inline constexpr size_t max_keys{100'000'000};
+inline constexpr size_t max_ops{1'000'000'000};
+inline constexpr size_t max_threads{1024};
+
+// parses a comma separated list of name=value pairs (e.g. "distribution=zipfian,threads=4,read=50,insert=50")
+// into spec, fields that are not mentioned keep their defaults.
+// Returns false (after printing the reason to std::cerr) for unknown names or invalid values.
+bool parse_workload(const std::string& text, workload_spec& spec);
+
+// runs the workload and prints throughput and latency percentiles to out
+void run_workload(const workload_spec& spec, std::ostream& out);
+
+#endif  // WORKLOAD_H
@@ -0,0 +1,121 @@
+#include "EH_adaptive_set.h"
+#include "EH_set.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+TEST_SUITE("EH_adaptive_set") {
+
+    TEST_CASE_TEMPLATE("DefaultConstructorEmpty", T, unsigned, std::uint64_t) {
+        EH_adaptive_set<T> set{};
+
+        CHECK_EQ(set.size(), 0);
+        CHECK(set.empty());
+        CHECK_EQ(set.depth(), 0);
+        CHECK_EQ(set.bucket_count(), 1);
+        CHECK_EQ(set.slot_count(), 16);
+        CHECK_FALSE(set.count(0));
+    }
+
+    TEST_CASE_TEMPLATE("InsertEraseCount", T, unsigned, std::uint64_t) {
+        EH_adaptive_set<T, 4> set{1, 2, 3};
+        CHECK_EQ(set.size(), 3);
+        CHECK(set.insert(4));
+        CHECK_FALSE(set.insert(2));
+        CHECK_EQ(set.size(), 4);
+        CHECK_EQ(set.erase(2), 1);
+        CHECK_EQ(set.erase(2), 0);
+        CHECK_FALSE(set.count(2));
+        CHECK(set.count(4));
+        CHECK_EQ(set.size(), 3);
+    }
+
+    TEST_CASE("GrowsBeforeDoubling") {
+        // the only Bucket is at global depth, so it grows through 4, 8 and 16 keys first
+        EH_adaptive_set<unsigned, 4> set{};
+        for (unsigned i{0}; i < 16; ++i) {
+            set.insert(i);
+        }
+        CHECK_EQ(set.depth(), 0);
+        CHECK_EQ(set.bucket_count(), 1);
+        CHECK_EQ(set.slot_count(), 16);
+
+        // the largest class splits, the halves shrink to fit their 9 and 8 keys
+        set.insert(16);
+        CHECK_EQ(set.depth(), 1);
+        CHECK_EQ(set.bucket_count(), 2);
+        CHECK_EQ(set.slot_count(), 16 + 8);
+        for (unsigned i{0}; i <= 16; ++i) {
+            CHECK(set.count(i));
+        }
+    }
+
+    TEST_CASE("SkewedHashes") {
+        // half of the keys share their 10 low hash bits (std::hash<unsigned> is the identity)
+        std::vector<unsigned> vals{};
+        for (unsigned i{0}; i < 2'000; ++i) {
+            vals.push_back(i << 10);
+            vals.push_back(i * 2'654'435'761u | 1);
+        }
+        EH_adaptive_set<unsigned, 8> adaptive{vals.begin(), vals.end()};
+        EH_set<unsigned, 8> plain{vals.begin(), vals.end()};
+        CHECK_EQ(adaptive.size(), plain.size());
+        CHECK_LT(adaptive.depth(), plain.depth());
+        // most Buckets hold few keys and stay in the smallest class
+        CHECK_LT(adaptive.slot_count(), adaptive.bucket_count() * 8 * 2);
+        for (unsigned v : vals) {
+            CHECK(adaptive.count(v));
+            CHECK_FALSE(adaptive.count(v + 2));
+        }
+    }
+
+    TEST_CASE("CopyAndForEach") {
+        EH_adaptive_set<unsigned, 8> set{};
+        for (unsigned i{0}; i < 1'000; ++i) {
+            set.insert(i);
+        }
+        EH_adaptive_set<unsigned, 8> copy{set};
+        CHECK_EQ(copy.depth(), set.depth());
+        CHECK_EQ(copy.slot_count(), set.slot_count());
+        copy.erase(5);
+        CHECK(set.count(5));
+        unsigned long long sum{0};
+        copy.for_each([&sum](unsigned k) { sum += k; });
+        CHECK_EQ(sum, 999ull * 1'000 / 2 - 5);
+
+        set = copy;
+        CHECK_EQ(set.size(), 999);
+        set.clear();
+        CHECK(set.empty());
+        CHECK_EQ(copy.size(), 999);
+
+        std::ostringstream out;
+        EH_adaptive_set<unsigned, 2>{1, 2, 3}.dump(out);
+        CHECK_NE(out.str().find("capacity = 4, arrsz = 3"), std::string::npos);
+    }
+
+    TEST_CASE("ManyValues") {
+        const size_t NUM = 1'000'000;
+        std::vector<unsigned> vals(NUM);
+        std::iota(vals.begin(), vals.end(), 0);
+        std::shuffle(vals.begin(), vals.end(), std::default_random_engine());
+
+        EH_adaptive_set<unsigned> set{vals.begin(), vals.end()};
+        CHECK_EQ(set.size(), NUM);
+        for (size_t i{0}; i < 10'000; ++i) {
+            CHECK_EQ(set.erase(vals[i]), 1);
+        }
+        CHECK_EQ(set.size(), NUM - 10'000);
+        for (size_t i{0}; i < NUM; ++i) {
+            CHECK_EQ(set.count(vals[i]), i >= 10'000);
+        }
+    }
+}
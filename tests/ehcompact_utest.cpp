@@ -0,0 +1,260 @@
+#include "EH_compact_set.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+TEST_SUITE("EH_compact_set") {
+
+    TEST_CASE_TEMPLATE("DefaultConstructorEmpty", T, unsigned, std::uint64_t) {
+        EH_compact_set<T> set{};
+
+        CHECK_EQ(set.size(), 0);
+        CHECK(set.empty());
+        CHECK_EQ(set.begin(), set.end());
+    }
+
+    TEST_CASE_TEMPLATE("InitListConstructor", T, unsigned, std::uint64_t) {
+        EH_compact_set<T> set{1, 2, 3};
+
+        CHECK_EQ(set.size(), 3);
+        CHECK(set.count(1));
+        CHECK(set.count(3));
+        CHECK_FALSE(set.count(4));
+    }
+
+    TEST_CASE_TEMPLATE("CopyAndAssign", T, unsigned, std::uint64_t) {
+        std::vector<T> vals(1'000);
+        std::iota(vals.begin(), vals.end(), 0);
+        EH_compact_set<T, 4> set{vals.begin(), vals.end()};
+
+        EH_compact_set<T, 4> copy{set};
+        CHECK_EQ(copy, set);
+
+        // copies must not share storage
+        copy.erase(1);
+        CHECK(set.count(1));
+        CHECK_FALSE(copy.count(1));
+
+        EH_compact_set<T, 4> assigned{7};
+        assigned = set;
+        CHECK_EQ(assigned, set);
+        CHECK_FALSE(assigned.count(1'000));
+
+        assigned = {1, 2, 3};
+        CHECK_EQ(assigned.size(), 3);
+        CHECK(assigned.count(2));
+        CHECK_FALSE(assigned.count(4));
+    }
+
+    TEST_CASE_TEMPLATE("InsertSingleValue", T, unsigned, std::uint64_t) {
+        EH_compact_set<T> set{};
+
+        {
+            auto [it, filled] = set.insert(1);
+            CHECK(filled);
+            CHECK_EQ(it, set.begin());
+        }
+
+        {
+            auto [it, filled] = set.insert(1);
+            CHECK_FALSE(filled);
+            CHECK_EQ(it, set.find(1));
+            CHECK_EQ(*it, 1);
+        }
+    }
+
+    TEST_CASE_TEMPLATE("Clear", T, unsigned, std::uint64_t) {
+        EH_compact_set<T> set{1, 2, 3};
+
+        set.clear();
+
+        CHECK(set.empty());
+        CHECK_FALSE(set.count(1));
+    }
+
+    TEST_CASE_TEMPLATE("Iter", T, unsigned, std::uint64_t) {
+        std::vector<T> vals(10'000);
+        std::iota(vals.begin(), vals.end(), 0);
+        EH_compact_set<T> set{vals.begin(), vals.end()};
+
+        size_t dist = std::distance(set.begin(), set.end());
+        CHECK_EQ(dist, set.size());
+
+        std::vector<T> copy{set.begin(), set.end()};
+        std::sort(copy.begin(), copy.end());
+        CHECK_EQ(copy, vals);
+    }
+
+    TEST_CASE_TEMPLATE("ManyValues", T, unsigned, std::uint64_t) {
+        const size_t NUM = 1'000'000;
+        std::vector<T> vals(NUM);
+        std::iota(vals.begin(), vals.end(), 0);
+        std::shuffle(vals.begin(), vals.end(), std::default_random_engine());
+
+        EH_compact_set<T> set{};
+        set.insert(vals.begin(), vals.end());
+        CHECK_EQ(set.size(), NUM);
+
+        // erase the first 10'000 elements
+        for (size_t i{0}; i < 10'000; ++i) {
+            CHECK_EQ(set.erase(vals[i]), 1);
+            CHECK_EQ(set.erase(vals[i]), 0);
+        }
+        CHECK_EQ(set.size(), NUM - 10'000);
+
+        for (size_t i{0}; i < NUM; ++i) {
+            CHECK_EQ(set.find(vals[i]) != set.end(), i >= 10'000);
+        }
+        CHECK_EQ(set.find(2'000'000), set.end());
+    }
+
+    TEST_CASE_TEMPLATE("SaveLoad", T, unsigned, std::uint64_t) {
+        std::vector<T> vals(10'000);
+        std::iota(vals.begin(), vals.end(), 0);
+        EH_compact_set<T, 8> set{vals.begin(), vals.end()};
+        set.erase(42);
+        std::ostringstream saved;
+        REQUIRE(set.save(saved));
+
+        EH_compact_set<T, 8> loaded{1, 2, 3};
+        std::istringstream in{saved.str()};
+        REQUIRE(loaded.load(in));
+        CHECK_EQ(loaded, set);
+        std::ostringstream dump, loaded_dump;
+        set.dump(dump);
+        loaded.dump(loaded_dump);
+        CHECK_EQ(loaded_dump.str(), dump.str());
+        loaded.insert(20'000);  // still grows after loading
+        CHECK(loaded.count(20'000));
+
+        // truncated, corrupted or mismatching images leave the set unchanged
+        const std::string bytes{saved.str()};
+        std::istringstream truncated{bytes.substr(0, bytes.size() - 1)};
+        CHECK_FALSE(loaded.load(truncated));
+        std::string corrupt{bytes};
+        corrupt[32 + 3] = '\xff';  // high byte of the first directory entry, behind the 32 byte header
+        std::istringstream corrupted{corrupt};
+        CHECK_FALSE(loaded.load(corrupted));
+        std::istringstream other_n{bytes};
+        EH_compact_set<T, 4> other{7};
+        CHECK_FALSE(other.load(other_n));
+        CHECK_EQ(other, EH_compact_set<T, 4>{7});
+        CHECK_EQ(loaded.size(), set.size() + 1);
+    }
+
+    TEST_CASE_TEMPLATE("LoadCorrupt", T, unsigned, std::uint64_t) {
+        // 0 2 4 and 1 3 in two Buckets of depth 1, at slots 0 and 1
+        EH_compact_set<T, 4> set{0, 1, 2, 3, 4};
+        std::ostringstream saved;
+        REQUIRE(set.save(saved));
+        const std::string bytes{saved.str()};
+        EH_compact_set<T, 4> loaded{7};
+        std::istringstream in{bytes};
+        REQUIRE(loaded.load(in));
+        CHECK_EQ(loaded, set);
+
+        // a huge directory and pool in the header fail on the missing bytes instead of being allocated
+        std::string huge{bytes.substr(0, 40)};
+        const std::uint32_t depth{30}, buckets{0x7fff'ffff};
+        std::memcpy(&huge[12], &depth, 4);
+        std::memcpy(&huge[16], &buckets, 4);
+        std::istringstream truncated{huge};
+        CHECK_FALSE(loaded.load(truncated));
+
+        // both slots point to the first Bucket, the second one is left without a slot
+        std::string shared{bytes};
+        std::memset(&shared[36], 0, 4);
+        std::istringstream shared_in{shared};
+        CHECK_FALSE(loaded.load(shared_in));
+
+        // key 0 in the first Bucket replaced by 5, which hashes to slot 1
+        std::string misplaced{bytes};
+        misplaced[40] = 5;
+        std::istringstream misplaced_in{misplaced};
+        CHECK_FALSE(loaded.load(misplaced_in));
+        CHECK_EQ(loaded, set);
+    }
+
+    TEST_CASE_TEMPLATE("View", T, unsigned, std::uint64_t) {
+        std::vector<T> vals(10'000);
+        std::iota(vals.begin(), vals.end(), 0);
+        EH_compact_set<T> set{vals.begin(), vals.end()};
+        std::ostringstream saved;
+        REQUIRE(set.save(saved));
+
+        // the image is used where it lies, e.g. in a mapped file
+        const std::string bytes{saved.str()};
+        std::vector<std::uint64_t> image((bytes.size() + 7) / 8);
+        std::copy(bytes.begin(), bytes.end(), reinterpret_cast<char*>(image.data()));
+        EH_compact_view<T> view{image.data(), bytes.size()};
+        REQUIRE(view.valid());
+        CHECK_EQ(view.size(), 10'000);
+        for (T i{0}; i < 20'000; ++i) {
+            CHECK_EQ(view.count(i), i < 10'000);
+        }
+
+        CHECK_FALSE((EH_compact_view<T>{image.data(), bytes.size() - 1}.valid()));
+        CHECK_FALSE((EH_compact_view<T, 8>{image.data(), bytes.size()}.valid()));
+        CHECK_FALSE(EH_compact_view<T>{}.valid());
+        CHECK_EQ(EH_compact_view<T>{}.count(1), 0);
+    }
+
+    TEST_CASE_TEMPLATE("Filter", T, unsigned, std::uint64_t) {
+        std::vector<T> vals(10'000);
+        std::iota(vals.begin(), vals.end(), 0);
+        std::shuffle(vals.begin(), vals.end(), std::default_random_engine());
+        EH_compact_set<T, 8, true> set{vals.begin(), vals.end()};
+        CHECK_GT(set.memory_usage(), EH_compact_set<T, 8>{vals.begin(), vals.end()}.memory_usage());
+
+        // the filters are rebuilt on every split, so no key that is inside may be ruled out
+        for (T i{0}; i < 20'000; ++i) {
+            CHECK_EQ(set.count(i), i < 10'000);
+            CHECK_EQ(set.find(i) != set.end(), i < 10'000);
+        }
+        CHECK_EQ(set.insert(42).second, false);
+        CHECK_EQ(set.erase(42), 1);
+        CHECK_FALSE(set.count(42));
+        CHECK(set.insert(42).second);
+
+        EH_compact_set<T, 8, true> copy{set};
+        set = {1, 2, 3};
+        CHECK_EQ(set.size(), 3);
+        CHECK_FALSE(set.count(4));
+        CHECK_EQ(copy.size(), 10'000);
+        CHECK(copy.count(9'999));
+
+        // the filters are part of the image, the set and the view only accept images with the same Filter
+        std::ostringstream saved;
+        REQUIRE(copy.save(saved));
+        const std::string bytes{saved.str()};
+        EH_compact_set<T, 8, true> loaded{};
+        std::istringstream in{bytes};
+        REQUIRE(loaded.load(in));
+        CHECK_EQ(loaded, copy);
+        std::istringstream truncated{bytes.substr(0, bytes.size() - 1)};
+        CHECK_FALSE(loaded.load(truncated));
+        std::istringstream no_filter{bytes};
+        EH_compact_set<T, 8> plain{};
+        CHECK_FALSE(plain.load(no_filter));
+
+        std::vector<std::uint64_t> image((bytes.size() + 7) / 8);
+        std::copy(bytes.begin(), bytes.end(), reinterpret_cast<char*>(image.data()));
+        EH_compact_view<T, 8, true> view{image.data(), bytes.size()};
+        REQUIRE(view.valid());
+        for (T i{0}; i < 20'000; ++i) {
+            CHECK_EQ(view.count(i), i < 10'000);
+        }
+        CHECK_FALSE((EH_compact_view<T, 8, true>{image.data(), bytes.size() - 1}.valid()));
+        CHECK_FALSE((EH_compact_view<T, 8>{image.data(), bytes.size()}.valid()));
+    }
+}
@@ -0,0 +1,194 @@
+#include "EH_linear_set.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+TEST_SUITE("EH_linear_set") {
+
+    TEST_CASE_TEMPLATE("DefaultConstructorEmpty", T, unsigned, std::uint64_t) {
+        EH_linear_set<T> set{};
+
+        CHECK_EQ(set.size(), 0);
+        CHECK(set.empty());
+        CHECK_EQ(set.bucket_count(), 1);
+        CHECK_FALSE(set.count(0));
+    }
+
+    TEST_CASE_TEMPLATE("InsertEraseCount", T, unsigned, std::uint64_t) {
+        EH_linear_set<T, 4> set{1, 2, 3};
+        CHECK_EQ(set.size(), 3);
+        CHECK(set.insert(4).second);
+        CHECK_FALSE(set.insert(2).second);
+        CHECK_EQ(*set.insert(2).first, 2);
+        CHECK_EQ(set.size(), 4);
+        CHECK_EQ(set.erase(2), 1);
+        CHECK_EQ(set.erase(2), 0);
+        CHECK_FALSE(set.count(2));
+        CHECK(set.count(4));
+        CHECK_EQ(set.size(), 3);
+    }
+
+    TEST_CASE("SplitsOneBucketAtATime") {
+        EH_linear_set<unsigned, 4> set{};
+        size_t buckets{set.bucket_count()};
+        for (unsigned i{0}; i < 10'000; ++i) {
+            set.insert(i);
+            CHECK_LE(set.bucket_count(), buckets + 1);
+            buckets = set.bucket_count();
+            CHECK_LE(static_cast<double>(set.size()), EH_linear_set<unsigned, 4>::max_load * buckets * 4 + 1);
+        }
+        // 0.8 * 4 keys per Bucket
+        CHECK_GE(buckets, 10'000 / 4);
+        CHECK_LE(buckets, 10'000 * 10 / 32 + 1);
+    }
+
+    TEST_CASE("OverflowChains") {
+        // equal low bits land in one Bucket until enough splits separate them
+        EH_linear_set<std::uint64_t, 4> set{};
+        std::vector<std::uint64_t> vals{};
+        for (std::uint64_t i{0}; i < 200; ++i) {
+            vals.push_back(i << 20);
+        }
+        set.insert(vals.begin(), vals.end());
+        CHECK_EQ(set.size(), vals.size());
+        for (auto v : vals) {
+            CHECK(set.count(v));
+            CHECK_FALSE(set.count(v + 1));
+        }
+        // erase from the middle of the chains
+        for (size_t i{0}; i < vals.size(); i += 2) {
+            CHECK_EQ(set.erase(vals[i]), 1);
+        }
+        for (size_t i{0}; i < vals.size(); ++i) {
+            CHECK_EQ(set.count(vals[i]), i % 2);
+        }
+        CHECK_EQ(set.size(), vals.size() / 2);
+    }
+
+    TEST_CASE("Strings") {
+        EH_linear_set<std::string, 2> set{};
+        for (int i{0}; i < 500; ++i) {
+            set.insert("key " + std::to_string(i));
+        }
+        for (int i{0}; i < 500; i += 3) {
+            CHECK_EQ(set.erase("key " + std::to_string(i)), 1);
+        }
+        CHECK_EQ(set.size(), 500 - 167);
+        CHECK(set.count("key 1"));
+        CHECK_FALSE(set.count("key 3"));
+    }
+
+    TEST_CASE("CopyAndForEach") {
+        EH_linear_set<unsigned, 8> set{};
+        for (unsigned i{0}; i < 1'000; ++i) {
+            set.insert(i);
+        }
+        EH_linear_set<unsigned, 8> copy{set};
+        copy.erase(5);
+        CHECK(set.count(5));
+        unsigned long long sum{0};
+        copy.for_each([&sum](unsigned k) { sum += k; });
+        CHECK_EQ(sum, 999ull * 1'000 / 2 - 5);
+
+        set = copy;
+        CHECK_EQ(set.size(), 999);
+        set.clear();
+        CHECK(set.empty());
+        CHECK_EQ(copy.size(), 999);
+    }
+
+    TEST_CASE("ManyValues") {
+        const size_t NUM = 1'000'000;
+        std::vector<unsigned> vals(NUM);
+        std::iota(vals.begin(), vals.end(), 0);
+        std::shuffle(vals.begin(), vals.end(), std::default_random_engine());
+
+        EH_linear_set<unsigned> set{vals.begin(), vals.end()};
+        CHECK_EQ(set.size(), NUM);
+        for (size_t i{0}; i < 10'000; ++i) {
+            CHECK_EQ(set.erase(vals[i]), 1);
+        }
+        CHECK_EQ(set.size(), NUM - 10'000);
+        for (size_t i{0}; i < NUM; ++i) {
+            CHECK_EQ(set.count(vals[i]), i >= 10'000);
+        }
+    }
+
+    TEST_CASE("IterateAndFind") {
+        EH_linear_set<std::uint64_t, 4> set{};
+        std::vector<std::uint64_t> vals{};
+        for (std::uint64_t i{0}; i < 2'000; ++i) {
+            vals.push_back(i % 3 ? i : i << 20);  // some long overflow chains as well
+        }
+        for (auto v : vals) {
+            auto [it, inserted] = set.insert(v);
+            CHECK(inserted);
+            CHECK_EQ(*it, v);
+        }
+        std::vector<std::uint64_t> seen(set.begin(), set.end());
+        std::sort(seen.begin(), seen.end());
+        std::sort(vals.begin(), vals.end());
+        CHECK_EQ(seen, vals);
+        for (auto v : vals) {
+            CHECK_EQ(*set.find(v), v);
+        }
+        CHECK_EQ(set.find(1u << 30), set.end());
+        CHECK_EQ(EH_linear_set<unsigned>{}.begin(), EH_linear_set<unsigned>{}.end());
+    }
+
+    TEST_CASE("CopyKeepsShape") {
+        EH_linear_set<std::string, 2> set{};
+        for (int i{0}; i < 3'000; ++i) {
+            set.insert(std::to_string(i));
+        }
+        EH_linear_set<std::string, 2> copy{set};
+        CHECK_EQ(copy.bucket_count(), set.bucket_count());
+        CHECK_EQ(copy, set);
+        CHECK(copy.insert("new").second);
+        CHECK_NE(copy, set);
+        CHECK_EQ(copy.erase("17"), 1);
+        CHECK(set.count("17"));
+    }
+
+    // generic code written once against EH_hash_set, for both growth policies
+    template <typename Set> void exercise(Set& set) {
+        for (unsigned i{0}; i < 5'000; ++i) {
+            CHECK(set.insert(i).second);
+        }
+        CHECK_FALSE(set.insert(7).second);
+        CHECK_EQ(*set.insert(7).first, 7);
+        CHECK_EQ(*set.find(42), 42);
+        CHECK_EQ(set.find(5'000), set.end());
+        unsigned long long sum{0};
+        for (unsigned key : set) {
+            sum += key;
+        }
+        CHECK_EQ(sum, 4'999ull * 5'000 / 2);
+        Set copy{set};
+        CHECK(copy == set);
+        CHECK_EQ(copy.erase(3), 1);
+        CHECK(copy != set);
+        std::vector<unsigned> more{5'000, 5'001, 3};
+        copy.insert(more.begin(), more.end());
+        CHECK_EQ(copy.size(), 5'002);
+        copy.clear();
+        CHECK(copy.empty());
+    }
+
+    TEST_CASE_TEMPLATE("GrowthPolicy", Growth, EH_directory_growth, EH_linear_growth) {
+        EH_hash_set<unsigned, 8, Growth> set{};
+        exercise(set);
+        CHECK_EQ(set.size(), 5'000);
+        CHECK(std::is_same_v<EH_hash_set<unsigned, 8, EH_linear_growth>, EH_linear_set<unsigned, 8>>);
+        CHECK(std::is_same_v<EH_hash_set<unsigned, 8>, EH_set<unsigned, 8>>);
+    }
+}
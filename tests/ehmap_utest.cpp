@@ -0,0 +1,149 @@
+#include "EH_map.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+// both Bucket layouts, small Buckets to force many splits
+using split_map = EH_map<int, std::string, 4, true>;
+using joint_map = EH_map<int, std::string, 4, false>;
+
+TEST_SUITE("EH_map") {
+
+    TEST_CASE_TEMPLATE("DefaultConstructorEmpty", M, split_map, joint_map) {
+        M map{};
+
+        CHECK_EQ(map.size(), 0);
+        CHECK(map.empty());
+        CHECK_EQ(map.begin(), map.end());
+    }
+
+    TEST_CASE_TEMPLATE("InitListConstructor", M, split_map, joint_map) {
+        M map{{1, "one"}, {2, "two"}, {1, "uno"}};
+
+        CHECK_EQ(map.size(), 2);
+        CHECK_EQ(map.find(1)->second, "one");
+        CHECK_EQ(map.find(2)->second, "two");
+        CHECK_FALSE(map.count(3));
+    }
+
+    TEST_CASE_TEMPLATE("SubscriptOperator", M, split_map, joint_map) {
+        M map{};
+
+        CHECK_EQ(map[1], "");
+        CHECK_EQ(map.size(), 1);
+
+        map[1] = "one";
+        map[2] += "two";
+        CHECK_EQ(map[1], "one");
+        CHECK_EQ(map[2], "two");
+        CHECK_EQ(map.size(), 2);
+    }
+
+    TEST_CASE_TEMPLATE("TryEmplace", M, split_map, joint_map) {
+        M map{};
+
+        {
+            auto [it, inserted] = map.try_emplace(1, 3, 'x');
+            CHECK(inserted);
+            CHECK_EQ(it->first, 1);
+            CHECK_EQ(it->second, "xxx");
+        }
+
+        {
+            // value is not consumed if the key is already inside
+            std::string value{"not moved"};
+            auto [it, inserted] = map.try_emplace(1, std::move(value));
+            CHECK_FALSE(inserted);
+            CHECK_EQ(it->second, "xxx");
+            CHECK_EQ(value, "not moved");
+        }
+    }
+
+    TEST_CASE_TEMPLATE("InsertOrAssign", M, split_map, joint_map) {
+        M map{};
+
+        CHECK(map.insert_or_assign(1, "one").second);
+        CHECK_FALSE(map.insert_or_assign(1, std::string{"uno"}).second);
+        CHECK_EQ(map[1], "uno");
+        CHECK_EQ(map.size(), 1);
+
+        CHECK_FALSE(map.insert({1, "eins"}).second);
+        CHECK_EQ(map[1], "uno");
+    }
+
+    TEST_CASE_TEMPLATE("ModifyThroughIterator", M, split_map, joint_map) {
+        M map{{1, "a"}, {2, "b"}, {3, "c"}};
+
+        for (auto [key, value] : map) {
+            value += std::to_string(key);
+        }
+        CHECK_EQ(map[1], "a1");
+        CHECK_EQ(map[3], "c3");
+
+        typename M::const_iterator cit{map.find(2)};
+        CHECK_EQ((*cit).second, "b2");
+        CHECK_EQ(cit, map.find(2));
+    }
+
+    TEST_CASE_TEMPLATE("CopyAndEquality", M, split_map, joint_map) {
+        M map{};
+        for (int i{0}; i < 1'000; ++i) {
+            map[i] = std::to_string(i);
+        }
+
+        M copy{map};
+        CHECK_EQ(copy, map);
+
+        copy[5] = "five";
+        CHECK_NE(copy, map);
+        CHECK_EQ(map[5], "5");
+
+        copy = map;
+        CHECK_EQ(copy, map);
+
+        copy.erase(5);
+        CHECK_NE(copy, map);
+        copy.clear();
+        CHECK(copy.empty());
+    }
+
+    TEST_CASE_TEMPLATE("ManyValues", M, split_map, joint_map) {
+        const int NUM = 100'000;
+        std::vector<int> keys(NUM);
+        std::iota(keys.begin(), keys.end(), 0);
+        std::shuffle(keys.begin(), keys.end(), std::default_random_engine());
+
+        M map{};
+        for (int key : keys) {
+            map.try_emplace(key, std::to_string(2 * key));
+        }
+        CHECK_EQ(map.size(), NUM);
+
+        for (int i{0}; i < NUM / 2; ++i) {
+            CHECK_EQ(map.erase(keys[i]), 1);
+        }
+        CHECK_EQ(map.size(), NUM / 2);
+
+        size_t seen{0};
+        for (const auto& [key, value] : map) {
+            CHECK_EQ(value, std::to_string(2 * key));
+            ++seen;
+        }
+        CHECK_EQ(seen, map.size());
+
+        std::unique_ptr<bool[]> found{new bool[NUM]};
+        map.count_batch(keys.data(), keys.size(), found.get());
+        for (int i{0}; i < NUM; ++i) {
+            CHECK_EQ(found[i], i >= NUM / 2);
+        }
+    }
+}
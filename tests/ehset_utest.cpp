@@ -2,9 +2,17 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <memory>
+#include <iterator>
+#include <limits>
 #include <numeric>
 #include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
 #include <vector>
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
@@ -32,6 +40,55 @@ template <> struct equal_to<double_w> {
 
 }  // namespace std
 
+// key that counts how often it is copied, to check that the set moves keys
+struct counted {
+    static inline size_t copies{0};
+    unsigned val{0};
+
+    counted(unsigned val) : val{val} {}
+    counted() = default;
+    counted(counted const& other) : val{other.val} { ++copies; }
+    counted(counted&&) noexcept = default;
+    counted& operator=(counted const& other) {
+        val = other.val;
+        ++copies;
+        return *this;
+    }
+    counted& operator=(counted&&) noexcept = default;
+};
+
+namespace std {
+template <> struct hash<counted> {
+    size_t operator()(counted const& c) const { return std::hash<unsigned>{}(c.val); }
+};
+
+template <> struct equal_to<counted> {
+    bool operator()(counted const& lhs, counted const& rhs) const { return lhs.val == rhs.val; }
+};
+}  // namespace std
+
+// key without default constructor that counts its live instances
+struct tracked {
+    static inline long live{0};
+    unsigned val;
+
+    explicit tracked(unsigned val) : val{val} { ++live; }
+    tracked(tracked const& other) : val{other.val} { ++live; }
+    tracked(tracked&& other) noexcept : val{other.val} { ++live; }
+    tracked& operator=(tracked const&) = default;
+    ~tracked() { --live; }
+};
+
+namespace std {
+template <> struct hash<tracked> {
+    size_t operator()(tracked const& t) const { return std::hash<unsigned>{}(t.val); }
+};
+
+template <> struct equal_to<tracked> {
+    bool operator()(tracked const& lhs, tracked const& rhs) const { return lhs.val == rhs.val; }
+};
+}  // namespace std
+
 TEST_SUITE("EH_set") {
 
     TEST_CASE_TEMPLATE("DefaultConstructorEmpty", T, double, double_w) {
@@ -294,4 +351,707 @@ TEST_SUITE("EH_set") {
             CHECK_NE(set.find(i), set.end());
         }
     }
+
+    TEST_CASE_TEMPLATE("CountBatch", T, double, double_w) {
+        const size_t NUM = 10'000;
+        std::vector<T> vals(NUM);
+        std::iota(vals.begin(), vals.end(), 0);
+
+        EH_set<T> set{vals.begin(), vals.begin() + NUM / 2};
+
+        // includes a partial last group
+        std::vector<T> keys(vals.begin() + NUM / 4, vals.end() - 3);
+        std::unique_ptr<bool[]> out{new bool[keys.size()]};
+        set.count_batch(keys.data(), keys.size(), out.get());
+
+        for (size_t i{0}; i < keys.size(); ++i) {
+            CHECK_EQ(out[i], static_cast<bool>(set.count(keys[i])));
+        }
+    }
+
+    TEST_CASE_TEMPLATE("FindBatch", T, double, double_w) {
+        const size_t NUM = 10'000;
+        std::vector<T> vals(NUM);
+        std::iota(vals.begin(), vals.end(), 0);
+        std::shuffle(vals.begin(), vals.end(), std::default_random_engine());
+
+        EH_set<T> set{vals.begin(), vals.begin() + NUM / 2};
+
+        std::vector<typename EH_set<T>::iterator> out(vals.size());
+        set.find_batch(vals.data(), vals.size(), out.data());
+
+        for (size_t i{0}; i < vals.size(); ++i) {
+            CHECK_EQ(out[i], set.find(vals[i]));
+        }
+    }
+
+    TEST_CASE("MoveInsertDoesNotCopy") {
+        EH_set<counted, 4> set{};
+        counted::copies = 0;
+
+        for (unsigned i{0}; i < 1'000; ++i) {
+            set.insert(counted{i});  // splits relocate keys as well
+        }
+        CHECK_EQ(set.size(), 1'000);
+        CHECK_EQ(counted::copies, 0);
+
+        std::vector<counted> vals(10);
+        std::iota(vals.begin(), vals.end(), 1'000);
+        set.insert(std::make_move_iterator(vals.begin()), std::make_move_iterator(vals.end()));
+        CHECK_EQ(set.size(), 1'010);
+        CHECK_EQ(counted::copies, 0);
+
+        // copying an existing key is skipped, a new one is copied once
+        const counted existing{5};
+        CHECK_FALSE(set.insert(existing).second);
+        CHECK_EQ(counted::copies, 0);
+        const counted fresh{2'000};
+        CHECK(set.insert(fresh).second);
+        CHECK_EQ(counted::copies, 1);
+    }
+
+    TEST_CASE_TEMPLATE("Emplace", T, double, double_w) {
+        EH_set<T> set{};
+
+        auto [it, filled] = set.emplace(1.0);
+        CHECK(filled);
+        CHECK_EQ(it, set.find(1));
+
+        std::tie(it, filled) = set.emplace(1.0);
+        CHECK_FALSE(filled);
+        CHECK_EQ(it, set.find(1));
+        CHECK_EQ(set.size(), 1);
+    }
+
+    TEST_CASE("EmplaceString") {
+        EH_set<std::string> set{};
+
+        CHECK(set.emplace(20, 'x').second);
+        CHECK(set.emplace("abc").second);
+        CHECK_FALSE(set.emplace(std::string(20, 'x')).second);
+        CHECK(set.count("abc"));
+        CHECK_EQ(set.size(), 2);
+    }
+
+    TEST_CASE("OnlyLiveSlotsAreConstructed") {
+        {
+            EH_set<tracked, 8> set{};
+            CHECK_EQ(tracked::live, 0);
+
+            for (unsigned i{0}; i < 1'000; ++i) {
+                set.emplace(i);
+            }
+            CHECK_EQ(tracked::live, 1'000);
+
+            for (unsigned i{0}; i < 500; ++i) {
+                CHECK_EQ(set.erase(tracked{i}), 1);
+            }
+            CHECK_EQ(tracked::live, 500);
+            CHECK(set.count(tracked{999}));
+
+            EH_set<tracked, 8> copy{set};
+            CHECK_EQ(tracked::live, 1'000);
+
+            copy.clear();
+            CHECK_EQ(tracked::live, 500);
+        }
+        CHECK_EQ(tracked::live, 0);
+    }
+
+    // sets of different sizes have directories of different depths, so both lockstep cases are hit
+    TEST_CASE("SetAlgebra") {
+        std::vector<unsigned> vals(6'000);
+        std::iota(vals.begin(), vals.end(), 0);
+        std::shuffle(vals.begin(), vals.end(), std::default_random_engine());
+
+        for (auto [na, nb] : {std::pair<size_t, size_t>{4'000, 100}, {100, 4'000}, {3'000, 3'000}, {0, 500}}) {
+            // b starts in the middle of a, so the sets overlap partly
+            const size_t offset{na / 2};
+            EH_set<unsigned, 4> a{vals.begin(), vals.begin() + na};
+            EH_set<unsigned, 4> b{vals.begin() + offset, vals.begin() + offset + nb};
+
+            auto in_a = [&](unsigned v) { return a.count(v) == 1; };
+            auto in_b = [&](unsigned v) { return b.count(v) == 1; };
+
+            auto u = set_union(a, b);
+            auto i = set_intersection(a, b);
+            auto d = set_difference(a, b);
+            for (unsigned v : vals) {
+                CHECK_EQ(u.count(v) == 1, in_a(v) || in_b(v));
+                CHECK_EQ(i.count(v) == 1, in_a(v) && in_b(v));
+                CHECK_EQ(d.count(v) == 1, in_a(v) && !in_b(v));
+            }
+            CHECK_EQ(u.size(), static_cast<size_t>(std::distance(u.begin(), u.end())));
+            CHECK_EQ(i.size(), static_cast<size_t>(std::distance(i.begin(), i.end())));
+            CHECK_EQ(d.size(), static_cast<size_t>(std::distance(d.begin(), d.end())));
+            CHECK_EQ(u.size() + i.size(), a.size() + b.size());
+            CHECK_EQ(d.size(), a.size() - i.size());
+
+            EH_set<unsigned, 4> m{a};
+            m.merge(b);
+            CHECK_EQ(m, u);
+            m.merge(m);
+            CHECK_EQ(m, u);
+        }
+    }
+
+    // number of keys in every Bucket, read from the saved image of set
+    template <typename Set> std::vector<size_t> bucket_fill(const Set& set) {
+        std::ostringstream saved;
+        REQUIRE(set.save(saved));
+        const std::string bytes{saved.str()};
+        const auto u32 = [&bytes](size_t at) {
+            uint32_t v{0};
+            std::memcpy(&v, bytes.data() + at, sizeof(v));
+            return size_t{v};
+        };
+        std::vector<size_t> fill{};
+        for (size_t at{10}; at < bytes.size(); at += 5 + u32(at + 1) * sizeof(typename Set::key_type)) {
+            fill.push_back(u32(at + 1));
+        }
+        return fill;
+    }
+
+    using small_set = EH_set<unsigned, 4>;
+    using digest_set = EH_set<unsigned, 4, true>;
+
+    // same keys, but b is deeper since it held more keys before, so Buckets are aligned on the smaller depth
+    TEST_CASE_TEMPLATE("EqualityDifferentShapes", T, small_set, digest_set) {
+        std::vector<unsigned> vals(2'000);
+        std::iota(vals.begin(), vals.end(), 0);
+        std::shuffle(vals.begin(), vals.end(), std::default_random_engine());
+
+        T a{vals.begin(), vals.begin() + 500};
+        T b{vals.rbegin(), vals.rend()};
+        for (size_t i{500}; i < vals.size(); ++i) {
+            b.erase(vals[i]);
+        }
+        CHECK_EQ(a, b);
+        CHECK_EQ(b, a);
+
+        // same size, one key differs
+        b.erase(vals[0]);
+        b.insert(vals[1'000]);
+        CHECK_NE(a, b);
+        CHECK_NE(b, a);
+
+        // the set algebra keeps the checksum up to date as well
+        T c{set_union(set_difference(a, b), set_intersection(b, a))};
+        CHECK_EQ(c, a);
+        c.merge(b);
+        a.insert(vals[1'000]);
+        CHECK_EQ(c, a);
+
+        c.clear();
+        a = T{};
+        CHECK_EQ(c, a);
+    }
+
+    TEST_CASE("DigestRegions") {
+        std::vector<unsigned> vals(3'000);
+        std::iota(vals.begin(), vals.end(), 0);
+        std::shuffle(vals.begin(), vals.end(), std::default_random_engine());
+
+        digest_set set{vals.begin(), vals.end()};
+        for (size_t i{0}; i < 1'000; ++i) {
+            set.erase(vals[i]);
+        }
+        CHECK_EQ(set.digest(), set.digest(0, 0));
+
+        // every region is the sum of its two halves, no matter how deep the Buckets are
+        for (size_t bits{0}; bits < set.depth() + 2; ++bits) {
+            for (size_t prefix{0}; prefix < (size_t{1} << bits); prefix += 3) {
+                size_t halves{set.digest(prefix, bits + 1) + set.digest(prefix + (size_t{1} << bits), bits + 1)};
+                CHECK_EQ(set.digest(prefix, bits), halves);
+
+                size_t keys{0};
+                set.for_each(prefix, bits, [&](unsigned key) {
+                    CHECK_EQ(std::hash<unsigned>{}(key) & ((size_t{1} << bits) - 1), prefix);
+                    ++keys;
+                });
+                size_t half_keys{0};
+                set.for_each(prefix, bits + 1, [&](unsigned) { ++half_keys; });
+                set.for_each(prefix + (size_t{1} << bits), bits + 1, [&](unsigned) { ++half_keys; });
+                CHECK_EQ(keys, half_keys);
+            }
+        }
+
+        // a region as wide as the hash (or wider) holds just the keys with exactly that hash
+        const size_t width{std::numeric_limits<size_t>::digits};
+        for (size_t bits : {width, width + 36}) {
+            size_t h{std::hash<unsigned>{}(vals[2'000])};
+            std::vector<unsigned> found{};
+            set.for_each(h, bits, [&](unsigned key) { found.push_back(key); });
+            CHECK_EQ(found, std::vector<unsigned>{vals[2'000]});
+            CHECK_EQ(set.digest(h, bits), set.digest(h, width - 1) - set.digest(h ^ (size_t{1} << (width - 1)), width));
+            CHECK_EQ(set.digest(std::hash<unsigned>{}(vals[0]), bits), 0);  // erased
+        }
+    }
+
+    // descends into the hash prefixes whose checksums differ and only sends those regions
+    TEST_CASE("DigestReplicaDiff") {
+        std::vector<unsigned> vals(5'000);
+        std::iota(vals.begin(), vals.end(), 0);
+
+        digest_set primary{vals.begin(), vals.end()};
+        digest_set replica{vals.rbegin(), vals.rend()};
+        std::vector<unsigned> missing{3, 77, 1'234, 4'999};
+        for (unsigned key : missing) {
+            replica.erase(key);
+        }
+        replica.insert(7'000);
+        CHECK_NE(primary.digest(), replica.digest());
+
+        size_t sent{0};
+        std::vector<std::pair<size_t, size_t>> todo{{0, 0}};
+        while (!todo.empty()) {
+            auto [prefix, bits] = todo.back();
+            todo.pop_back();
+            if (primary.digest(prefix, bits) == replica.digest(prefix, bits)) {
+                continue;
+            }
+            if (bits < primary.depth()) {
+                todo.push_back({prefix, bits + 1});
+                todo.push_back({prefix + (size_t{1} << bits), bits + 1});
+                continue;
+            }
+            // the replica drops what it has on its own and takes the region from the primary
+            std::vector<unsigned> stale{};
+            replica.for_each(prefix, bits, [&](unsigned key) { stale.push_back(key); });
+            for (unsigned key : stale) {
+                replica.erase(key);
+            }
+            primary.for_each(prefix, bits, [&](unsigned key) {
+                replica.insert(key);
+                ++sent;
+            });
+        }
+
+        CHECK_EQ(primary, replica);
+        CHECK_EQ(primary.digest(), replica.digest());
+        CHECK_LE(sent, (missing.size() + 1) * 4);
+    }
+
+    TEST_CASE("SnapshotSharesBuckets") {
+        {
+            EH_set<tracked, 8> set{};
+            for (unsigned i{0}; i < 1'000; ++i) {
+                set.emplace(i);
+            }
+            CHECK_EQ(tracked::live, 1'000);
+
+            auto snap = set.snapshot();
+            CHECK_EQ(tracked::live, 1'000);  // no key is copied
+            CHECK_EQ(snap, set);
+
+            // only the Bucket the key goes to is cloned
+            set.emplace(1'000u);
+            CHECK_GT(tracked::live, 1'001);
+            CHECK_LE(tracked::live, 1'001 + 8);
+            CHECK_EQ(snap.size(), 1'000);
+            CHECK_FALSE(snap.count(tracked{1'000}));
+
+            for (unsigned i{0}; i < 500; ++i) {
+                set.erase(tracked{i});
+                set.emplace(i + 2'000);
+            }
+            CHECK_EQ(snap.size(), 1'000);
+            for (unsigned i{0}; i < 1'000; ++i) {
+                CHECK(snap.count(tracked{i}));
+                CHECK_EQ(set.count(tracked{i}), i >= 500);
+            }
+
+            // the snapshot can be modified on its own as well
+            auto snap2 = snap.snapshot();
+            snap.erase(tracked{999});
+            CHECK(snap2.count(tracked{999}));
+            CHECK_EQ(snap2.size(), 1'000);
+
+            set = EH_set<tracked, 8>{};  // clears shared Buckets without touching the snapshots
+            CHECK(set.empty());
+            CHECK_EQ(snap.size(), 999);
+            CHECK_EQ(std::distance(snap2.begin(), snap2.end()), 1'000);
+        }
+        CHECK_EQ(tracked::live, 0);
+    }
+
+    TEST_CASE("SnapshotDigest") {
+        std::vector<unsigned> vals(2'000);
+        std::iota(vals.begin(), vals.end(), 0);
+
+        digest_set set{vals.begin(), vals.end()};
+        digest_set copy{set};
+        auto snap = set.snapshot();
+        CHECK_EQ(snap.digest(), set.digest());
+
+        set.erase(17);
+        set.merge(digest_set{5'000, 5'001});
+        CHECK_EQ(snap, copy);
+        CHECK_EQ(snap.digest(), copy.digest());
+        CHECK_EQ(snap.digest(5, 3), copy.digest(5, 3));
+
+        auto diff = set_difference(snap, set);
+        CHECK_EQ(diff, digest_set{17});
+    }
+
+    // the target ends up with the shape of the source, no matter how deep it was before
+    TEST_CASE("AssignClonesShape") {
+        std::vector<unsigned> vals(3'000);
+        std::iota(vals.begin(), vals.end(), 0);
+        std::shuffle(vals.begin(), vals.end(), std::default_random_engine());
+
+        auto dump = [](const auto& set) {
+            std::ostringstream o{};
+            set.dump(o);
+            return o.str();
+        };
+
+        EH_set<unsigned, 4> small{vals.begin(), vals.begin() + 100};
+        EH_set<unsigned, 4> large{vals.begin(), vals.end()};
+        EH_set<unsigned, 4> target{vals.begin() + 500, vals.begin() + 1'500};
+
+        target = large;
+        CHECK_EQ(dump(target), dump(large));
+        target = small;
+        CHECK_EQ(dump(target), dump(small));
+        target = target;
+        CHECK_EQ(dump(target), dump(small));
+
+        {
+            EH_set<tracked, 4> from{};
+            EH_set<tracked, 4> to{};
+            for (unsigned i{0}; i < 1'000; ++i) {
+                from.emplace(i);
+                to.emplace(i + 1'000);
+            }
+            auto snap = to.snapshot();
+            to = from;  // Buckets shared with snap are left alone
+            CHECK_EQ(to, from);
+            CHECK(snap.count(tracked{1'500}));
+            CHECK_EQ(tracked::live, 3'000);
+
+            from.clear();
+            to = from;
+            CHECK(to.empty());
+            CHECK_EQ(tracked::live, 1'000);
+        }
+        CHECK_EQ(tracked::live, 0);
+    }
+
+    TEST_CASE_TEMPLATE("InsertBatch", T, double, double_w) {
+        const size_t NUM = 10'000;
+        std::vector<T> vals(NUM);
+        std::iota(vals.begin(), vals.end(), 0);
+        std::shuffle(vals.begin(), vals.end(), std::default_random_engine());
+
+        EH_set<T> set{vals.begin(), vals.begin() + NUM / 4};
+        // overlaps the keys inside and has duplicates within a group
+        vals.insert(vals.end(), vals.begin() + NUM / 2, vals.begin() + NUM / 2 + 7);
+        set.insert_batch(vals.data(), vals.size());
+
+        CHECK_EQ(set.size(), NUM);
+        CHECK_EQ(set, EH_set<T>(vals.begin(), vals.end()));
+    }
+
+    TEST_CASE("Reserve") {
+        EH_set<unsigned, 4> set{1, 2, 3};
+        set.reserve(1'000);
+        const size_t depth{set.depth()};
+        CHECK_GE((size_t{1} << depth) * 4, 1'000);
+        CHECK_EQ(set.size(), 3);
+        CHECK(set.count(2));
+
+        // evenly spread keys fit in without growing the directory
+        std::vector<unsigned> vals(1'000);
+        std::iota(vals.begin(), vals.end(), 0);
+        set.insert_batch(vals.data(), vals.size());
+        CHECK_EQ(set.depth(), depth);
+        CHECK_EQ(set.size(), 1'000);
+
+        set.reserve(10);  // never shrinks
+        CHECK_EQ(set.depth(), depth);
+    }
+
+    TEST_CASE("SaveLoad") {
+        std::vector<unsigned> vals(500);
+        std::iota(vals.begin(), vals.end(), 0);
+        EH_set<unsigned, 4, true> set{vals.begin(), vals.end()};
+        std::ostringstream saved;
+        REQUIRE(set.save(saved));
+
+        EH_set<unsigned, 4, true> restored{7, 8, 9};
+        std::istringstream in{saved.str()};
+        REQUIRE(restored.load(in));
+        CHECK_EQ(restored, set);
+        CHECK_EQ(restored.depth(), set.depth());
+        CHECK_EQ(restored.digest(), set.digest());
+        std::ostringstream dump, restored_dump;
+        set.dump(dump);
+        restored.dump(restored_dump);
+        CHECK_EQ(restored_dump.str(), dump.str());
+        restored.insert(1'000);
+        CHECK(restored.count(1'000));
+
+        // truncated or mismatching input leaves the set unchanged
+        const std::string bytes{saved.str()};
+        std::istringstream truncated{bytes.substr(0, bytes.size() - 1)};
+        CHECK_FALSE(restored.load(truncated));
+        std::istringstream wrong_n{bytes};
+        EH_set<unsigned, 8> other{1, 2};
+        CHECK_FALSE(other.load(wrong_n));
+        CHECK_EQ(other, EH_set<unsigned, 8>{1, 2});
+
+        // a corrupt global depth fails on the missing Buckets, before the directory is allocated
+        std::string deep{bytes};
+        deep[9] = 40;  // behind "EHS1", the key size and N
+        std::istringstream corrupt_depth{deep};
+        CHECK_FALSE(restored.load(corrupt_depth));
+        std::istringstream header_only{std::string{"EHS1\x04\x04\x00\x00\x00\x28", 10}};
+        CHECK_FALSE(restored.load(header_only));
+
+        // keys of the first Bucket (slot 0) start behind its local depth and count, a key that hashes to
+        // another slot or a duplicate would be loaded but never found
+        uint32_t count{0};
+        std::memcpy(&count, bytes.data() + 11, sizeof(count));
+        REQUIRE_GE(count, 2);
+        unsigned first{0};
+        std::memcpy(&first, bytes.data() + 15, sizeof(first));
+        std::string misplaced{bytes};
+        const unsigned moved{first ^ 1u};
+        std::memcpy(misplaced.data() + 15, &moved, sizeof(moved));
+        std::istringstream corrupt_key{misplaced};
+        CHECK_FALSE(restored.load(corrupt_key));
+        std::string duplicate{bytes};
+        std::memcpy(duplicate.data() + 19, &first, sizeof(first));
+        std::istringstream corrupt_duplicate{duplicate};
+        CHECK_FALSE(restored.load(corrupt_duplicate));
+        CHECK_EQ(restored.size(), vals.size() + 1);
+        CHECK(restored.count(1'000));
+    }
+
+    using fill_set = EH_set<unsigned, 16, false, EH_split_at_fill<50>>;
+    using probe_set = EH_set<unsigned, 16, true, EH_split_at_probe<4>>;
+    using deferred_set = EH_set<unsigned, 4, false, EH_split_deferred>;
+
+    TEST_CASE_TEMPLATE("SplitPolicyManyValues", T, fill_set, probe_set, deferred_set) {
+        const size_t NUM = 100'000;
+        std::vector<unsigned> vals(NUM);
+        std::iota(vals.begin(), vals.end(), 0);
+        std::shuffle(vals.begin(), vals.end(), std::mt19937{42});
+        T set{vals.begin(), vals.begin() + NUM / 2};
+        set.insert_batch(vals.data() + NUM / 2, NUM - NUM / 2);
+        CHECK_EQ(set.size(), NUM);
+        for (size_t i{0}; i < NUM; i += 2) {
+            CHECK_EQ(set.erase(vals[i]), 1);
+        }
+        CHECK_EQ(set.size(), NUM / 2);
+        for (size_t i{0}; i < NUM; ++i) {
+            CHECK_EQ(set.count(vals[i]), i % 2);
+        }
+
+        T other{vals.begin(), vals.begin() + 100};
+        other.merge(set);
+        CHECK_EQ(other.size(), NUM / 2 + 50);
+        CHECK_EQ(static_cast<size_t>(std::distance(other.begin(), other.end())), other.size());
+
+        std::ostringstream saved;
+        REQUIRE(other.save(saved));
+        T restored{};
+        std::istringstream in{saved.str()};
+        REQUIRE(restored.load(in));
+        CHECK_EQ(restored, other);
+    }
+
+    TEST_CASE("SplitEarly") {
+        std::vector<unsigned> vals(10'000);
+        std::iota(vals.begin(), vals.end(), 0);
+        const EH_set<unsigned, 16> plain{vals.begin(), vals.end()};
+        const fill_set fill{vals.begin(), vals.end()};
+        const probe_set probe{vals.begin(), vals.end()};
+
+        // splitting early gives more, emptier Buckets
+        const auto mean = [](const std::vector<size_t>& f) {
+            return static_cast<double>(std::accumulate(f.begin(), f.end(), size_t{0})) / f.size();
+        };
+        CHECK_GE(fill.depth(), plain.depth());
+        CHECK_LT(mean(bucket_fill(fill)), mean(bucket_fill(plain)));
+        CHECK_LT(mean(bucket_fill(probe)), mean(bucket_fill(fill)));
+        // a Bucket at the threshold is split before it takes a key, so it exceeds it only if all its
+        // keys stayed on one side
+        const std::vector<size_t> probe_fill{bucket_fill(probe)};
+        CHECK_LE(*std::max_element(probe_fill.begin(), probe_fill.end()), 16);
+        CHECK_LT(std::count_if(probe_fill.begin(), probe_fill.end(), [](size_t n) { return n > 4; }),
+                 probe_fill.size() / 10);
+    }
+
+    TEST_CASE("SplitDeferred") {
+        // a full Bucket at global depth takes one more key before the directory doubles
+        deferred_set set{};
+        EH_set<unsigned, 4> plain{};
+        for (unsigned i{0}; i < 4; ++i) {
+            set.insert(i);
+            plain.insert(i);
+        }
+        CHECK_EQ(set.depth(), 0);
+        set.insert(4);
+        plain.insert(4);
+        CHECK_EQ(set.depth(), 0);
+        CHECK_EQ(plain.depth(), 1);
+        CHECK_EQ(bucket_fill(set), std::vector<size_t>{5});
+        set.insert(5);
+        CHECK_GE(set.depth(), 1);
+        CHECK_EQ(set.size(), 6);
+
+        std::vector<unsigned> vals(10'000);
+        std::iota(vals.begin(), vals.end(), 0);
+        set.insert(vals.begin(), vals.end());
+        plain.insert(vals.begin(), vals.end());
+        CHECK_LE(set.depth(), plain.depth());
+        const std::vector<size_t> fill{bucket_fill(set)};
+        CHECK_LE(*std::max_element(fill.begin(), fill.end()), 5);
+
+        // a Bucket using the spare slot does not fit a set without one
+        std::ostringstream saved;
+        REQUIRE(deferred_set{0, 1, 2, 3, 4}.save(saved));
+        std::istringstream in{saved.str()};
+        EH_set<unsigned, 4> small{};
+        CHECK_FALSE(small.load(in));
+        std::istringstream again{saved.str()};
+        deferred_set restored{};
+        REQUIRE(restored.load(again));
+        CHECK_EQ(restored.size(), 5);
+    }
+
+    using indexed_set = EH_set<unsigned, 128, false, EH_split_on_overflow, EH_indexed_layout>;
+    using indexed_digest_set = EH_set<unsigned, 8, true, EH_split_deferred, EH_indexed_layout>;
+    using sorted_set = EH_set<unsigned, 64, false, EH_split_on_overflow, EH_sorted_layout>;
+    using sorted_digest_set = EH_set<unsigned, 8, true, EH_split_at_fill<75>, EH_sorted_layout>;
+
+    TEST_CASE_TEMPLATE("BucketLayouts", T, indexed_set, indexed_digest_set, sorted_set, sorted_digest_set) {
+        const size_t NUM = 100'000;
+        std::vector<unsigned> vals(NUM);
+        std::iota(vals.begin(), vals.end(), 0);
+        std::shuffle(vals.begin(), vals.end(), std::mt19937{7});
+        T set{vals.begin(), vals.begin() + NUM / 2};
+        set.insert_batch(vals.data() + NUM / 2, NUM - NUM / 2);
+        CHECK_EQ(set.size(), NUM);
+        for (size_t i{0}; i < NUM; i += 2) {
+            CHECK_EQ(set.erase(vals[i]), 1);
+        }
+        for (size_t i{0}; i < NUM; ++i) {
+            CHECK_EQ(set.count(vals[i]), i % 2);
+            CHECK_EQ(set.find(vals[i]) != set.end(), i % 2 == 1);
+        }
+        CHECK_FALSE(set.count(NUM));
+
+        // operations that move keys between and within Buckets keep the index in sync
+        T snapshot{set.snapshot()};
+        T other{vals.begin(), vals.begin() + 1'000};
+        other.merge(set);
+        CHECK_EQ(other.size(), NUM / 2 + 500);
+        CHECK_EQ(set_intersection(other, snapshot), set);
+        CHECK_EQ(set_difference(other, set).size(), 500);
+        for (size_t i{0}; i < 1'000; i += 2) {
+            CHECK(other.count(vals[i]));
+        }
+
+        std::ostringstream saved;
+        REQUIRE(other.save(saved));
+        T restored{1, 2, 3};
+        std::istringstream in{saved.str()};
+        REQUIRE(restored.load(in));
+        CHECK_EQ(restored, other);
+        for (size_t i{0}; i < NUM; ++i) {
+            CHECK_EQ(restored.count(vals[i]), other.count(vals[i]));
+        }
+    }
+
+    TEST_CASE("IndexedLayoutStrings") {
+        EH_set<std::string, 64, false, EH_split_on_overflow, EH_indexed_layout> set{};
+        for (int i{0}; i < 5'000; ++i) {
+            set.insert("key " + std::to_string(i));
+        }
+        for (int i{0}; i < 5'000; i += 3) {
+            CHECK_EQ(set.erase("key " + std::to_string(i)), 1);
+        }
+        CHECK_EQ(set.size(), 5'000 - 1'667);
+        for (int i{0}; i < 5'000; ++i) {
+            CHECK_EQ(set.count("key " + std::to_string(i)), i % 3 != 0);
+        }
+        auto copy{set};
+        CHECK_EQ(copy, set);
+
+        const long before{tracked::live};
+        {
+            EH_set<tracked, 32, false, EH_split_on_overflow, EH_indexed_layout> t{};
+            for (unsigned i{0}; i < 1'000; ++i) {
+                t.emplace(i);
+            }
+            CHECK_EQ(t.erase(tracked{7}), 1);
+            CHECK(t.count(tracked{8}));
+            CHECK_EQ(tracked::live, before + 999);
+        }
+        CHECK_EQ(tracked::live, before);
+    }
+
+    TEST_CASE("SortedLayoutKeepsOrder") {
+        std::vector<unsigned> vals(20'000);
+        std::iota(vals.begin(), vals.end(), 0);
+        std::shuffle(vals.begin(), vals.end(), std::mt19937{3});
+        sorted_set set{};
+        for (unsigned v : vals) {
+            auto [it, inserted] = set.insert(v);
+            CHECK(inserted);
+            CHECK_EQ(*it, v);  // points to the key at its sorted place
+        }
+        for (size_t i{0}; i < vals.size(); i += 3) {
+            set.erase(vals[i]);
+        }
+        EH_set<unsigned, 64, false, EH_split_on_overflow, EH_sorted_layout> other{vals.begin(), vals.begin() + 100};
+        set.merge(other);
+        CHECK_EQ(set.size(), vals.size() - vals.size() / 3 + 33);
+
+        // the image lists every Bucket's keys in storage order, merge and retain keep them sorted
+        auto buckets_sorted = [](const sorted_set& s) {
+            std::ostringstream saved;
+            REQUIRE(s.save(saved));
+            const std::string bytes{saved.str()};
+            size_t buckets{0};
+            for (size_t at{10}; at < bytes.size(); ++buckets) {
+                uint32_t n{0};
+                std::memcpy(&n, bytes.data() + at + 1, sizeof(n));
+                std::vector<unsigned> keys(n);
+                if (n) {
+                    std::memcpy(keys.data(), bytes.data() + at + 5, n * sizeof(unsigned));
+                }
+                CHECK(std::is_sorted(keys.begin(), keys.end()));
+                at += 5 + n * sizeof(unsigned);
+            }
+            return buckets;
+        };
+        CHECK_GT(buckets_sorted(set), 1);
+        sorted_set evens{};
+        for (unsigned v{0}; v < 20'000; v += 2) {
+            evens.insert(v);
+        }
+        sorted_set common{set_intersection(set, evens)};
+        sorted_set odd{set_difference(set, evens)};
+        CHECK_EQ(common.size() + odd.size(), set.size());
+        for (unsigned v{0}; v < 20'000; ++v) {
+            CHECK_EQ(common.count(v), set.count(v) && v % 2 == 0);
+            CHECK_EQ(odd.count(v), set.count(v) && v % 2 == 1);
+        }
+        buckets_sorted(common);
+        buckets_sorted(odd);
+
+        // an unsorted image is sorted on load
+        std::ostringstream unsorted;
+        REQUIRE(EH_set<unsigned, 64>{5, 3, 9, 1}.save(unsorted));
+        std::istringstream in{unsorted.str()};
+        sorted_set loaded{};
+        REQUIRE(loaded.load(in));
+        CHECK_EQ(std::vector<unsigned>(loaded.begin(), loaded.end()), std::vector<unsigned>{1, 3, 5, 9});
+        CHECK(loaded.count(9));
+        CHECK_FALSE(loaded.count(4));
+    }
 }
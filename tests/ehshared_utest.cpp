@@ -0,0 +1,152 @@
+#include "EH_shared_set.h"
+
+#include <memory>
+#include <numeric>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+// segment name that is unique for this process
+static std::string segment(const char* test) { return "/eh_shared_utest_" + std::to_string(::getpid()) + test; }
+
+TEST_CASE("CreateAndOpen") {
+    const std::string name{segment("open")};
+    auto writer{EH_shared_set<unsigned, 4>::create(name.c_str(), 10'000)};
+    REQUIRE(writer.attached());
+    for (unsigned i{0}; i < 10'000; ++i) {
+        REQUIRE(writer.insert(i));
+    }
+    CHECK(writer.insert(5));  // already inside
+    CHECK_EQ(writer.size(), 10'000);
+
+    // a second mapping of the same segment sees every key
+    auto reader{EH_shared_set<unsigned, 4>::open(name.c_str())};
+    REQUIRE(reader.attached());
+    CHECK_EQ(reader.size(), 10'000);
+    CHECK_EQ(reader.depth(), writer.depth());
+    std::vector<unsigned> keys(20'000);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::unique_ptr<bool[]> found{new bool[keys.size()]};
+    reader.count_batch(keys.data(), keys.size(), found.get());
+    for (unsigned i{0}; i < keys.size(); ++i) {
+        CHECK_EQ(found[i], i < 10'000);
+    }
+
+    CHECK_EQ(writer.erase(7), 1);
+    CHECK_EQ(writer.erase(7), 0);
+    CHECK_FALSE(reader.count(7));
+    unsigned long long sum{0};
+    reader.for_each([&sum](unsigned k) { sum += k; });
+    CHECK_EQ(sum, 9'999ull * 10'000 / 2 - 7);
+
+    reader.clear();
+    CHECK(writer.empty());
+    CHECK(EH_shared_set<unsigned, 4>::remove(name.c_str()));
+    CHECK(writer.insert(1));  // mapping stays valid after remove
+    CHECK_FALSE(EH_shared_set<unsigned, 4>::open(name.c_str()).attached());
+}
+
+TEST_CASE("OpenMismatch") {
+    const std::string name{segment("mismatch")};
+    auto set{EH_shared_set<unsigned, 4>::create(name.c_str(), 100)};
+    REQUIRE(set.attached());
+    CHECK_FALSE((EH_shared_set<unsigned, 8>::open(name.c_str()).attached()));
+    CHECK_FALSE((EH_shared_set<unsigned long long, 4>::open(name.c_str()).attached()));
+    // an existing segment is never replaced under the processes that mapped it
+    CHECK_FALSE((EH_shared_set<unsigned, 4>::create(name.c_str(), 100).attached()));
+    CHECK(set.insert(1));
+    EH_shared_set<unsigned, 4> moved{std::move(set)};
+    CHECK_FALSE(set.attached());
+    CHECK(moved.attached());
+    CHECK(EH_shared_set<unsigned, 4>::remove(name.c_str()));
+}
+
+TEST_CASE("OutOfSpace") {
+    const std::string name{segment("space")};
+    auto set{EH_shared_set<unsigned, 4>::create(name.c_str(), 8)};
+    REQUIRE(set.attached());
+    unsigned inserted{0};
+    while (set.insert(inserted)) {
+        ++inserted;
+    }
+    CHECK_GE(inserted, 8);
+    CHECK_EQ(set.size(), inserted);
+    CHECK_LE(set.size(), set.bucket_capacity() * 4);
+    for (unsigned i{0}; i < inserted; ++i) {
+        CHECK(set.count(i));
+    }
+    CHECK_FALSE(set.count(inserted));
+
+    set.clear();
+    CHECK(set.insert(inserted));
+    CHECK_EQ(set.size(), 1);
+    CHECK(EH_shared_set<unsigned, 4>::remove(name.c_str()));
+}
+
+TEST_CASE("ReaderProcess") {
+    const std::string name{segment("process")};
+    auto writer{EH_shared_set<unsigned>::create(name.c_str(), 100'000)};
+    REQUIRE(writer.attached());
+
+    pid_t pid{::fork()};
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+        // looks up while the parent inserts: keys are inserted in order, so every key below one that was
+        // found has to be there as well
+        auto reader{EH_shared_set<unsigned>::open(name.c_str())};
+        bool ok{reader.attached()};
+        for (unsigned last{0}; ok && last < 100'000;) {
+            while (last < 100'000 && reader.count(last)) {
+                ++last;
+            }
+            ok = reader.size() >= last && (last == 0 || reader.count(last / 2));
+        }
+        ::_exit(ok ? 0 : 1);
+    }
+    for (unsigned i{0}; i < 100'000; ++i) {
+        writer.insert(i);
+    }
+    int status{-1};
+    ::waitpid(pid, &status, 0);
+    CHECK_EQ(status, 0);
+    CHECK(EH_shared_set<unsigned>::remove(name.c_str()));
+}
+
+TEST_CASE("WriterNotStarved") {
+    const std::string name{segment("starve")};
+    auto writer{EH_shared_set<unsigned>::create(name.c_str(), 20'000)};
+    REQUIRE(writer.attached());
+
+    // readers look up back to back, so their shared holds keep overlapping; the writer still gets through
+    // because the lock prefers writers. Every reader stops once it sees the last key
+    std::vector<pid_t> readers{};
+    for (int r{0}; r < 4; ++r) {
+        pid_t pid{::fork()};
+        REQUIRE(pid >= 0);
+        if (pid == 0) {
+            auto reader{EH_shared_set<unsigned>::open(name.c_str())};
+            std::vector<unsigned> keys(256);
+            std::iota(keys.begin(), keys.end(), 0);
+            std::unique_ptr<bool[]> found{new bool[keys.size()]};
+            while (reader.attached() && !reader.count(20'000)) {
+                reader.count_batch(keys.data(), keys.size(), found.get());
+            }
+            ::_exit(reader.attached() ? 0 : 1);
+        }
+        readers.push_back(pid);
+    }
+    for (unsigned i{0}; i <= 20'000; ++i) {
+        REQUIRE(writer.insert(i));
+    }
+    for (pid_t pid : readers) {
+        int status{-1};
+        ::waitpid(pid, &status, 0);
+        CHECK_EQ(status, 0);
+    }
+    CHECK_EQ(writer.size(), 20'001);
+    CHECK(EH_shared_set<unsigned>::remove(name.c_str()));
+}
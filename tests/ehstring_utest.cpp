@@ -0,0 +1,142 @@
+#include "EH_string_set.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+// keys of different lengths, most of them too long for small string optimization
+static std::vector<std::string> make_keys(size_t num) {
+    std::vector<std::string> keys{};
+    keys.reserve(num);
+    for (size_t i{0}; i < num; ++i) {
+        keys.push_back(std::string(i % 40, 'x') + std::to_string(i));
+    }
+    return keys;
+}
+
+TEST_SUITE("EH_string_set") {
+
+    TEST_CASE("DefaultConstructorEmpty") {
+        EH_string_set<> set{};
+
+        CHECK_EQ(set.size(), 0);
+        CHECK(set.empty());
+        CHECK_EQ(set.begin(), set.end());
+    }
+
+    TEST_CASE("InitListConstructor") {
+        EH_string_set<> set{"a", "bb", "", "a"};
+
+        CHECK_EQ(set.size(), 3);
+        CHECK(set.count("a"));
+        CHECK(set.count(""));
+        CHECK(set.count(std::string{"bb"}));
+        CHECK_FALSE(set.count("b"));
+    }
+
+    TEST_CASE("InsertFindErase") {
+        EH_string_set<4> set{};
+
+        {
+            auto [it, filled] = set.insert("hello");
+            CHECK(filled);
+            CHECK_EQ(*it, "hello");
+            CHECK_EQ(it->size(), 5);
+        }
+
+        {
+            std::string key{"hello"};
+            auto [it, filled] = set.insert(key);
+            CHECK_FALSE(filled);
+            CHECK_EQ(it, set.find("hello"));
+        }
+
+        CHECK_EQ(set.erase("hello"), 1);
+        CHECK_EQ(set.erase("hello"), 0);
+        CHECK_EQ(set.find("hello"), set.end());
+        CHECK(set.empty());
+    }
+
+    TEST_CASE("EmptyKeyFirst") {
+        EH_string_set<> set{};
+        CHECK(set.insert("").second);
+        CHECK(set.insert("abc").second);  // grows the arena the empty key left null
+        CHECK(set.count(""));
+        CHECK(set.count("abc"));
+
+        // splits re-append into Buckets whose arena was dropped
+        EH_string_set<4> small{};
+        CHECK(small.insert("").second);
+        auto keys{make_keys(1'000)};
+        small.insert(keys.begin(), keys.end());
+        CHECK_EQ(small.size(), keys.size() + 1);
+        CHECK(small.count(""));
+        for (const std::string& key : keys) {
+            CHECK(small.count(key));
+        }
+    }
+
+    TEST_CASE("CopyAndAssign") {
+        auto keys{make_keys(1'000)};
+        EH_string_set<4> set{keys.begin(), keys.end()};
+
+        EH_string_set<4> copy{set};
+        CHECK_EQ(copy, set);
+
+        // the copy owns its bytes
+        copy.erase(keys[0]);
+        CHECK(set.count(keys[0]));
+        CHECK_FALSE(copy.count(keys[0]));
+
+        EH_string_set<4> assigned{"other"};
+        assigned = set;
+        CHECK_EQ(assigned, set);
+
+        assigned = {"a", "b"};
+        CHECK_EQ(assigned.size(), 2);
+        CHECK_FALSE(assigned.count(keys[1]));
+    }
+
+    TEST_CASE("Iter") {
+        auto keys{make_keys(5'000)};
+        EH_string_set<> set{keys.begin(), keys.end()};
+
+        std::vector<std::string> copy{};
+        for (std::string_view key : set) {
+            copy.emplace_back(key);
+        }
+        std::sort(copy.begin(), copy.end());
+        std::sort(keys.begin(), keys.end());
+        CHECK_EQ(copy, keys);
+    }
+
+    TEST_CASE("ManyValuesEraseAndReinsert") {
+        auto keys{make_keys(100'000)};
+        std::shuffle(keys.begin(), keys.end(), std::default_random_engine());
+
+        EH_string_set<> set{keys.begin(), keys.end()};
+        CHECK_EQ(set.size(), keys.size());
+
+        // erasing leaves garbage in the arenas, reinserting must reclaim it
+        for (size_t round{0}; round < 3; ++round) {
+            for (size_t i{0}; i < 50'000; ++i) {
+                CHECK_EQ(set.erase(keys[i]), 1);
+            }
+            CHECK_EQ(set.size(), keys.size() - 50'000);
+            for (size_t i{0}; i < 50'000; ++i) {
+                CHECK(set.insert(keys[i]).second);
+            }
+        }
+
+        for (const std::string& key : keys) {
+            CHECK_NE(set.find(key), set.end());
+        }
+        CHECK_FALSE(set.count("not inside"));
+    }
+}
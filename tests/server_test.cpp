@@ -0,0 +1,204 @@
+// starts the playground given as first argument with --serve and talks to it over loopback
+
+#include <arpa/inet.h>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT
+#include "doctest.h"
+
+static const char* playground{nullptr};
+
+// the playground running as server, its output is read through a pipe
+struct server_process {
+    pid_t pid{-1};
+    int output{-1};
+    std::string text{};
+
+    explicit server_process(const char* shards) {
+        int fds[2];
+        REQUIRE(::pipe(fds) == 0);
+        pid = ::fork();
+        REQUIRE(pid >= 0);
+        if (pid == 0) {
+            ::dup2(fds[1], STDOUT_FILENO);
+            ::close(fds[0]);
+            ::close(fds[1]);
+            ::execl(playground, playground, "--serve", "0", "--shards", shards, static_cast<char*>(nullptr));
+            ::_exit(127);
+        }
+        ::close(fds[1]);
+        output = fds[0];
+    }
+    ~server_process() {
+        if (pid > 0) {
+            ::kill(pid, SIGKILL);
+            ::waitpid(pid, nullptr, 0);
+        }
+        ::close(output);
+    }
+
+    // reads output until it contains needle, returns false on EOF
+    bool read_until(const char* needle) {
+        char buf[256];
+        while (text.find(needle) == std::string::npos) {
+            ssize_t n{::read(output, buf, sizeof(buf))};
+            if (n <= 0) {
+                return false;
+            }
+            text.append(buf, static_cast<size_t>(n));
+        }
+        return true;
+    }
+
+    uint16_t port() {
+        REQUIRE(read_until("shard(s)"));
+        return static_cast<uint16_t>(std::stoul(text.substr(text.find("port ") + 5)));
+    }
+
+    // stops the server with SIGTERM, returns its exit status
+    int stop() {
+        ::kill(pid, SIGTERM);
+        read_until("final size");
+        int status{0};
+        ::waitpid(pid, &status, 0);
+        pid = -1;
+        return status;
+    }
+};
+
+static int connect_to(uint16_t port) {
+    int fd{::socket(AF_INET, SOCK_STREAM, 0)};
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    REQUIRE(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    return fd;
+}
+
+static void put_u32(std::string& out, uint32_t value) {
+    for (int i{0}; i < 4; ++i) {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+static std::string request(char op, const std::vector<uint32_t>& keys) {
+    std::string frame{};
+    put_u32(frame, static_cast<uint32_t>(1 + 4 * keys.size()));
+    frame.push_back(op);
+    for (uint32_t key : keys) {
+        put_u32(frame, key);
+    }
+    return frame;
+}
+
+static void send_all(int fd, const std::string& bytes) {
+    for (size_t sent{0}; sent < bytes.size();) {
+        ssize_t n{::send(fd, bytes.data() + sent, bytes.size() - sent, 0)};
+        REQUIRE(n > 0);
+        sent += static_cast<size_t>(n);
+    }
+}
+
+static bool recv_all(int fd, char* buf, size_t len) {
+    for (size_t got{0}; got < len;) {
+        ssize_t n{::recv(fd, buf + got, len - got, 0)};
+        if (n <= 0) {
+            return false;
+        }
+        got += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// reads one reply frame and checks its op, returns the body
+static std::string reply(int fd, char op) {
+    unsigned char len[4];
+    REQUIRE(recv_all(fd, reinterpret_cast<char*>(len), 4));
+    size_t n{len[0] | size_t{len[1]} << 8 | size_t{len[2]} << 16 | size_t{len[3]} << 24};
+    std::string frame(n, '\0');
+    REQUIRE(recv_all(fd, frame.data(), n));
+    REQUIRE(n >= 1);
+    CHECK_EQ(frame[0], op);
+    return frame.substr(1);
+}
+
+static uint64_t number(const std::string& body) {
+    uint64_t value{0};
+    for (size_t i{body.size()}; i-- > 0;) {
+        value = value << 8 | static_cast<unsigned char>(body[i]);
+    }
+    return value;
+}
+
+static std::vector<uint32_t> range(uint32_t first, uint32_t last) {
+    std::vector<uint32_t> keys{};
+    for (uint32_t k{first}; k < last; ++k) {
+        keys.push_back(k);
+    }
+    return keys;
+}
+
+TEST_CASE_TEMPLATE("PipelinedRequests", Shards, std::integral_constant<int, 1>, std::integral_constant<int, 4>) {
+    server_process server{Shards::value == 1 ? "1" : "4"};
+    int fd{connect_to(server.port())};
+
+    // all requests go out before the first reply is read
+    send_all(fd, request('i', range(0, 1000)) + request('i', range(500, 1500)) + request('c', range(1000, 3000)) +
+                     request('r', range(0, 100)) + request('f', {0, 100, 1499, 1500}) + request('s', {}));
+    CHECK_EQ(number(reply(fd, 'i')), 1000);
+    CHECK_EQ(number(reply(fd, 'i')), 500);
+    CHECK_EQ(number(reply(fd, 'c')), 500);
+    CHECK_EQ(number(reply(fd, 'r')), 100);
+    CHECK_EQ(reply(fd, 'f'), std::string{"\0\1\1\0", 4});
+    CHECK_EQ(number(reply(fd, 's')), 1400);
+
+    // a second client sees the same keys
+    int other{connect_to(server.port())};
+    send_all(other, request('c', range(0, 200)));
+    CHECK_EQ(number(reply(other, 'c')), 100);
+    ::close(other);
+    ::close(fd);
+
+    CHECK_EQ(server.stop(), 0);
+    CHECK_NE(server.text.find("served 7 requests with 4304 keys on 2 connections"), std::string::npos);
+    CHECK_NE(server.text.find("final size 1400"), std::string::npos);
+}
+
+TEST_CASE("MalformedRequest") {
+    server_process server{"2"};
+    int fd{connect_to(server.port())};
+    send_all(fd, request('x', {1}));
+    reply(fd, 'e');
+    char byte;
+    CHECK_EQ(::recv(fd, &byte, 1, 0), 0);  // closed by the server
+    ::close(fd);
+
+    fd = connect_to(server.port());
+    std::string frame{};
+    put_u32(frame, 3);  // not 1 + 4 * keys
+    send_all(fd, frame + "iab");
+    reply(fd, 'e');
+    ::close(fd);
+    CHECK_EQ(server.stop(), 0);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s PLAYGROUND [doctest options]\n", argv[0]);
+        return 1;
+    }
+    playground = argv[1];
+    doctest::Context context{argc - 1, argv + 1};
+    return context.run();
+}